@@ -4,6 +4,7 @@
 import qflib as qf
 import numpy as np
 import os
+import time
 
 ver = qf.version()
 print(f'qflib version: {ver}')
@@ -91,6 +92,19 @@ euro = qf.euroBS(payofftype = 1, spot = 100, timetoexp = 1.0, strike = 100,
 print('European option using Black-Scholes analytic solution')
 print(f'Price={euro:.4f}')
 
+#eurobsvec
+strikes = np.linspace(50, 150, 1000001)
+start = time.perf_counter()
+euros = qf.euroBSVec(payofftype = 1, spot = 100, timetoexp = 1.0, strike = strikes,
+                     intrate = 0.02, divyield = 0.04, volatility = 0.4)
+elapsed = time.perf_counter() - start
+print(f'{euros.size} European options in one vectorized call: {elapsed:.3f} sec')
+
+greeks = qf.euroBSGreeks(payofftype = 1, spot = 100, timetoexp = 1.0, strike = 100,
+                         intrate = 0.02, divyield = 0.04, volatility = 0.4)
+print('European option price and Greeks using Black-Scholes analytic solution')
+print(greeks)
+
 #%%
 # function group 2
 print('================')
@@ -109,5 +123,60 @@ spotrate = qf.spotRate(ycname = yc, tmat = 2)
 fwdrate = qf.fwdRate(ycname = yc, tmat1 = 1, tmat2 = 2)
 print(f'DF={df:.4f}, SpotRate={spotrate:.4f} FwdRate={fwdrate:.4f}')
 
+#discountjac, fwdratejac
+dfjac = qf.discountJac(ycname = yc, tmats = [1, 2, 5])
+fwdjac = qf.fwdRateJac(ycname = yc, tmats1 = [1, 2], tmats2 = [2, 3])
+print('Discount factor derivatives by the input spot rates')
+print(dfjac)
+print('Forward rate derivatives by the input spot rates')
+print(fwdjac)
+
+#discountvec
+dfs = qf.discountVec(ycname = yc, tmats = np.arange(0.5, 10.5, 0.5))
+print('Discount factors every 6 months')
+print(dfs)
+
 print('Market list')
-print(qf.mktList())
\ No newline at end of file
+print(qf.mktList())
+
+#mktsave, mktload
+mktfile = os.path.join(os.getcwd(), 'qflib-market.bin')
+qf.mktSave(path = mktfile)
+qf.mktClear()
+print('Market loaded from file')
+print(qf.mktLoad(path = mktfile))
+
+#mcgbm
+mc = qf.mcGBM(payoff = 'ASIAN', payofftype = 1, strike = 100, fixtimes = [i/12 for i in range(1, 13)],
+              spot = 100, divyield = 0.02, volatility = 0.3, ycname = yc, npaths = 100000)
+print('Asian option using Monte Carlo simulation')
+print(mc)
+
+#fdgbm
+fd = qf.fdGBM(payofftype = -1, american = True, strikes = [90, 100, 110], timestoexp = [0.5, 1.0],
+              spot = 100, divyield = 0.02, volatility = 0.3, ycname = yc)
+print('American puts using finite differences')
+print(fd)
+
+#latticegbm
+strikes = np.linspace(80, 120, 41)
+lat = qf.latticeGBM(payofftypes = [1] * strikes.size, strikes = strikes, timetoexp = 1.0, spot = 100,
+                    divyield = 0.02, volatility = 0.3, ycname = yc, exercise = 'EUROPEAN',
+                    lattice = 'TRINOMIAL', smoothing = True, richardson = True)
+intrate = qf.spotRate(ycname = yc, tmat = 1.0)
+start = time.perf_counter()
+bs = [qf.euroBS(payofftype = 1, spot = 100, strike = k, timetoexp = 1.0, intrate = intrate,
+                divyield = 0.02, volatility = 0.3) for k in strikes]
+bstime = time.perf_counter() - start
+print('European calls on a trinomial lattice vs Black-Scholes')
+print(f'Max abs diff={np.max(np.abs(lat["Prices"] - bs)):.2e}, lattice time={lat["Time"]:.4f}s, BS time={bstime:.4f}s')
+
+#setnumthreads, concurrent calls from Python threads
+from concurrent.futures import ThreadPoolExecutor
+nthreads = qf.setNumThreads(nthreads = 0)
+spots = [np.random.uniform(80, 120, 1000000) for _ in range(4)]
+start = time.perf_counter()
+with ThreadPoolExecutor(max_workers = 4) as pool:
+    prices = list(pool.map(lambda s: qf.euroBSVec(payofftype = 1, spot = s, strike = 100, timetoexp = 1.0,
+                                                  intrate = 0.03, divyield = 0.02, volatility = 0.3), spots))
+print(f'4 x 1M European calls from 4 Python threads on {nthreads} native threads: {time.perf_counter() - start:.4f}s')
@@ -38,6 +38,29 @@ if (!(condition)) { \
             return nullptr; \
     }
 
+/** Releases the GIL for its lifetime, so that other Python threads run while C++ code computes.
+    No Python object may be used while it lives. Objects created before it, such as the
+    converted arguments, are destroyed after it, with the GIL held again; so is an exception
+    thrown meanwhile caught by PY_END.
+*/
+class PyAllowThreads
+{
+public:
+    PyAllowThreads() : state_(PyEval_SaveThread()) {}
+    ~PyAllowThreads() { PyEval_RestoreThread(state_); }
+
+    PyAllowThreads(PyAllowThreads const&) = delete;
+    PyAllowThreads& operator=(PyAllowThreads const&) = delete;
+
+private:
+    PyThreadState* state_;
+};
+
+// Enclose a pure C++ section between PY_BEGIN and PY_END, after the arguments are converted
+#define PY_NOGIL_BEGIN { PyAllowThreads pyAllowThreads_;
+
+#define PY_NOGIL_END }
+
 static bool isNone(PyObject* p)
 {
   return p == Py_None;
@@ -141,7 +164,8 @@ static PyObject* asPyScalar(const char* s)
 
 static std::vector<int> asIntVec(PyObject* pobj)
 {
-    PyObject* arr = PyArray_FROM_OTF(pobj, NPY_LONG, NPY_IN_ARRAY);
+    // NPY_INT matches the C int read below; NPY_LONG is 64 bits on Linux and macOS
+    PyObject* arr = PyArray_FROM_OTF(pobj, NPY_INT, NPY_IN_ARRAY | NPY_ARRAY_FORCECAST);
     if (arr == nullptr)
         return std::vector<int>();
     try {
@@ -434,4 +458,76 @@ static PyObject* newPyObject(std::string const& moduleName, std::string const& c
     return pynewobj;
 }
 
+/** A numeric array argument of a vectorized function: a Python scalar, sequence or numpy array,
+    viewed as a contiguous 1-D array of T. Contiguous arrays of the right dtype are used in place;
+    others are converted once. Scalars and arrays of length 1 broadcast to any length, as in numpy.
+*/
+template<typename T, int NPYTYPE>
+class PyArrayArg
+{
+public:
+    explicit PyArrayArg(PyObject* pobj, char const* name)
+        : arr_(PyArray_FROM_OTF(pobj, NPYTYPE, NPY_ARRAY_IN_ARRAY | NPY_ARRAY_FORCECAST)), name_(name)
+    {
+        CASSERT(arr_ != nullptr, std::string(name) + ": argument not convertible to a numeric array");
+        int ndim = PyArray_NDIM((PyArrayObject*) arr_);
+        if (ndim > 1) {
+            Py_DECREF(arr_);
+            CASSERT(false, std::string(name) + ": argument is not a scalar or one dimensional");
+        }
+        size_ = ndim == 0 ? 1 : (size_t) PyArray_DIM((PyArrayObject*) arr_, 0);
+        data_ = (T const*) PyArray_DATA((PyArrayObject*) arr_);
+    }
+
+    ~PyArrayArg() { Py_DECREF(arr_); }
+
+    PyArrayArg(PyArrayArg const&) = delete;
+    PyArrayArg& operator=(PyArrayArg const&) = delete;
+
+    /** Returns the number of elements */
+    size_t size() const { return size_; }
+
+    /** Returns element i, broadcasting arrays of length 1 */
+    T operator[](size_t i) const { return data_[size_ == 1 ? 0 : i]; }
+
+    /** Returns a pointer to n elements: the data itself if it has length n,
+        otherwise the element broadcast into buf
+    */
+    T const* broadcast(size_t n, std::vector<T>& buf) const
+    {
+        if (size_ == n)
+            return data_;
+        CASSERT(size_ == 1, std::string(name_) + ": cannot broadcast an array of length "
+                + std::to_string(size_) + " to length " + std::to_string(n));
+        buf.assign(n, data_[0]);
+        return buf.data();
+    }
+
+private:
+    PyObject* arr_;
+    char const* name_;
+    T const* data_;
+    size_t size_;
+};
+
+using PyDblArrayArg = PyArrayArg<double, NPY_DOUBLE>;
+using PyIntArrayArg = PyArrayArg<int, NPY_INT>;
+
+/** Returns the common length of vectorized arguments, as numpy broadcasting:
+    all arguments must have length 1 or the same length n
+*/
+template<typename... ARGS>
+static size_t broadcastSize(ARGS const&... args)
+{
+    size_t n = 1;
+    for (size_t sz : { args.size()... }) {
+        if (sz == 1)
+            continue;
+        CASSERT(n == 1 || sz == n, "arguments of lengths " + std::to_string(n) + " and "
+                + std::to_string(sz) + " cannot be broadcast together");
+        n = sz;
+    }
+    return n;
+}
+
 #endif // PYCPP_HPP
@@ -129,8 +129,8 @@ PY_BEGIN;
   if (!PyArg_ParseTuple(pyArgs, "O", &pyMat))
     return NULL;
 
-  qf::Matrix mat = asMatrix(pyMat);
-  return asNumpy(mat);
+  PyMatrixView mat(pyMat);
+  return asNumpy(*mat);
 PY_END;
 }
 
@@ -146,20 +146,21 @@ PY_BEGIN;
   if (!PyArg_ParseTuple(pyArgs, "OOOOO", &pyBkPoints, &pyValues, &pyPolyOrder, &pyXVec, &pyDerivOrder))
     return NULL;
 
-  qf::Vector bkpts = asVector(pyBkPoints);
-  qf::Vector vals = asVector(pyValues);
+  PyVectorView bkpts(pyBkPoints);
+  PyVectorView vals(pyValues);
   int degree = asInt(pyPolyOrder);
-  qf::Vector xx = asVector(pyXVec);
-  QF_ASSERT(bkpts.size() == vals.size(), "unequal number of breakpoints and vals");
+  PyVectorView xx(pyXVec);
+  QF_ASSERT(bkpts->size() == vals->size(), "unequal number of breakpoints and vals");
   int derivOrder = asInt(pyDerivOrder);
 
+  qf::Vector yy(xx->size());
+  PY_NOGIL_BEGIN;
   // create the curve
-  qf::PiecewisePolynomial pp(bkpts.begin(), bkpts.end(), vals.begin(), degree);
+  qf::PiecewisePolynomial pp(bkpts->begin(), bkpts->end(), vals->begin(), degree);
+  pp.eval(xx->begin(), xx->end(), yy.begin(), derivOrder);
+  PY_NOGIL_END;
 
-  qf::Vector yy(xx.size());
-  pp.eval(xx.begin(), xx.end(), yy.begin(), derivOrder);
-
-  return asNumpy(yy);
+  return asNumpy(std::move(yy));
 PY_END;
 }
 
@@ -175,19 +176,21 @@ PY_BEGIN;
   if (!PyArg_ParseTuple(pyArgs, "OOOOO", &pyBkPoints, &pyValues, &pyPolyOrder, &pyXStart, &pyXVecEnd))
     return NULL;
 
-  qf::Vector bkpts = asVector(pyBkPoints);
-  qf::Vector vals = asVector(pyValues);
-  QF_ASSERT(bkpts.size() == vals.size(), "unequal number of breakpoints and vals");
+  PyVectorView bkpts(pyBkPoints);
+  PyVectorView vals(pyValues);
+  QF_ASSERT(bkpts->size() == vals->size(), "unequal number of breakpoints and vals");
   int degree = asInt(pyPolyOrder);
   double x0 = asDouble(pyXStart);
-  qf::Vector xx = asVector(pyXVecEnd);
+  PyVectorView xx(pyXVecEnd);
+  qf::Vector yy(xx->size());
+  PY_NOGIL_BEGIN;
   // create the curve
-  qf::PiecewisePolynomial pp(bkpts.begin(), bkpts.end(), vals.begin(), degree);
+  qf::PiecewisePolynomial pp(bkpts->begin(), bkpts->end(), vals->begin(), degree);
   // integrate
-  qf::Vector yy(xx.size());
-  pp.integral(x0, xx.begin(), xx.end(), yy.begin());
+  pp.integral(x0, xx->begin(), xx->end(), yy.begin());
+  PY_NOGIL_END;
 
-  return asNumpy(yy);
+  return asNumpy(std::move(yy));
 PY_END;
 }
 
@@ -202,12 +205,12 @@ PY_BEGIN;
   if (!PyArg_ParseTuple(pyArgs, "OOOO", &pyCoeffs, &pyLowerLimit, &pyUpperLimit, &pyNSubs))
     return NULL;
 
-  qf::Vector coeffs = asVector(pyCoeffs);
+  PyVectorView coeffs(pyCoeffs);
   double xlo = asDouble(pyLowerLimit);
   double xhi = asDouble(pyUpperLimit);
   int nsubs = asInt(pyNSubs);
 
-  qf::Polynomial p(coeffs);
+  qf::Polynomial p(*coeffs);
   qf::Vector xb1, xb2;
   int nroot;
   qf::zbrak(p, xlo, xhi, nsubs, xb1, xb2, nroot);
@@ -217,7 +220,7 @@ PY_BEGIN;
     bkts(i, 0) = xb1[i];
     bkts(i, 1) = xb2[i];
   };
-  return asNumpy(bkts);
+  return asNumpy(std::move(bkts));
 PY_END;
 }
 
@@ -232,12 +235,12 @@ PY_BEGIN;
   if (!PyArg_ParseTuple(pyArgs, "OOOO", &pyCoeffs, &pyLowerLimit, &pyUpperLimit, &pyTol))
     return NULL;
 
-  qf::Vector coeffs = asVector(pyCoeffs);
+  PyVectorView coeffs(pyCoeffs);
   double xlo = asDouble(pyLowerLimit);
   double xhi = asDouble(pyUpperLimit);
   double tol = asDouble(pyTol);
 
-  qf::Polynomial p(coeffs);
+  qf::Polynomial p(*coeffs);
   double root = qf::rtsec(p, xlo, xhi, tol);
   return asPyScalar(root);
 PY_END;
@@ -2,11 +2,29 @@
 @file  pyfunctions1.hpp
 @brief Implementation of Python callable functions
 */
-#include "pycpp.hpp"
+#include <pyqflib/pyutils.hpp>
 #include <qflib/defines.hpp>
 #include <qflib/pricers/simplepricers.hpp>
+#include <qflib/pricers/bsgreeks.hpp>
 #include <string>
 
+// Converts a BSGreeks struct to a Python dictionary
+static PyObject* asPyDict(qf::BSGreeks const& g)
+{
+  PyObject* ret = PyDict_New();
+  PyDict_SetItemString(ret, "Price", asPyScalar(g.price));
+  PyDict_SetItemString(ret, "Delta", asPyScalar(g.delta));
+  PyDict_SetItemString(ret, "Gamma", asPyScalar(g.gamma));
+  PyDict_SetItemString(ret, "Vega", asPyScalar(g.vega));
+  PyDict_SetItemString(ret, "Theta", asPyScalar(g.theta));
+  PyDict_SetItemString(ret, "Rho", asPyScalar(g.rho));
+  PyDict_SetItemString(ret, "DivRho", asPyScalar(g.divRho));
+  PyDict_SetItemString(ret, "Vanna", asPyScalar(g.vanna));
+  PyDict_SetItemString(ret, "Volga", asPyScalar(g.volga));
+  PyDict_SetItemString(ret, "Charm", asPyScalar(g.charm));
+  return ret;
+}
+
 static
 PyObject*  pyQfFwdPrice(PyObject* pyDummy, PyObject* pyArgs)
 {
@@ -93,3 +111,145 @@ PY_BEGIN;
   return asPyScalar(price);
 PY_END;
 }
+
+static
+PyObject*  pyQfDigiBSVec(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffType(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pyStrike(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pyIntRate(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVolatility(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOO", &pyPayoffType, &pySpot, &pyStrike,
+    &pyTimeToExp, &pyIntRate, &pyDivYield, &pyVolatility))
+    return NULL;
+
+  PyIntArrayArg payoffType(pyPayoffType, "payofftype");
+  PyDblArrayArg spot(pySpot, "spot");
+  PyDblArrayArg strike(pyStrike, "strike");
+  PyDblArrayArg timeToExp(pyTimeToExp, "timetoexp");
+  PyDblArrayArg intRate(pyIntRate, "intrate");
+  PyDblArrayArg divYield(pyDivYield, "divyield");
+  PyDblArrayArg vol(pyVolatility, "volatility");
+  size_t n = broadcastSize(payoffType, spot, strike, timeToExp, intRate, divYield, vol);
+
+  // scalars are broadcast into buffers, arrays are passed in place
+  std::vector<int> ibuf;
+  std::vector<double> dbuf[6];
+  qf::Vector price(n);
+  PY_NOGIL_BEGIN;
+  qf::digitalOptionBS(n, payoffType.broadcast(n, ibuf), spot.broadcast(n, dbuf[0]), strike.broadcast(n, dbuf[1]),
+    timeToExp.broadcast(n, dbuf[2]), intRate.broadcast(n, dbuf[3]), divYield.broadcast(n, dbuf[4]),
+    vol.broadcast(n, dbuf[5]), price.memptr());
+  PY_NOGIL_END;
+
+  return asNumpy(std::move(price));
+PY_END;
+}
+
+static
+PyObject*  pyQfEuroBSVec(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffType(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pyStrike(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pyIntRate(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVolatility(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOO", &pyPayoffType, &pySpot, &pyStrike,
+    &pyTimeToExp, &pyIntRate, &pyDivYield, &pyVolatility))
+    return NULL;
+
+  PyIntArrayArg payoffType(pyPayoffType, "payofftype");
+  PyDblArrayArg spot(pySpot, "spot");
+  PyDblArrayArg strike(pyStrike, "strike");
+  PyDblArrayArg timeToExp(pyTimeToExp, "timetoexp");
+  PyDblArrayArg intRate(pyIntRate, "intrate");
+  PyDblArrayArg divYield(pyDivYield, "divyield");
+  PyDblArrayArg vol(pyVolatility, "volatility");
+  size_t n = broadcastSize(payoffType, spot, strike, timeToExp, intRate, divYield, vol);
+
+  // scalars are broadcast into buffers, arrays are passed in place
+  std::vector<int> ibuf;
+  std::vector<double> dbuf[6];
+  qf::Vector price(n);
+  PY_NOGIL_BEGIN;
+  qf::europeanOptionBS(n, payoffType.broadcast(n, ibuf), spot.broadcast(n, dbuf[0]), strike.broadcast(n, dbuf[1]),
+    timeToExp.broadcast(n, dbuf[2]), intRate.broadcast(n, dbuf[3]), divYield.broadcast(n, dbuf[4]),
+    vol.broadcast(n, dbuf[5]), price.memptr());
+  PY_NOGIL_END;
+
+  return asNumpy(std::move(price));
+PY_END;
+}
+
+static
+PyObject*  pyQfDigiBSGreeks(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffType(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pyStrike(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pyIntRate(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVolatility(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOO", &pyPayoffType, &pySpot, &pyStrike,
+    &pyTimeToExp, &pyIntRate, &pyDivYield, &pyVolatility))
+    return NULL;
+
+  int payoffType = asInt(pyPayoffType);
+  double spot = asDouble(pySpot);
+  double strike = asDouble(pyStrike);
+  double timeToExp = asDouble(pyTimeToExp);
+  double intRate = asDouble(pyIntRate);
+  double divYield = asDouble(pyDivYield);
+  double vol = asDouble(pyVolatility);
+
+  qf::BSGreeks greeks = qf::digitalOptionBSGreeks(payoffType, spot, strike, timeToExp, intRate, divYield, vol);
+
+  return asPyDict(greeks);
+PY_END;
+}
+
+static
+PyObject*  pyQfEuroBSGreeks(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayoffType(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pyStrike(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pyIntRate(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVolatility(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOO", &pyPayoffType, &pySpot, &pyStrike,
+    &pyTimeToExp, &pyIntRate, &pyDivYield, &pyVolatility))
+    return NULL;
+
+  int payoffType = asInt(pyPayoffType);
+  double spot = asDouble(pySpot);
+  double strike = asDouble(pyStrike);
+  double timeToExp = asDouble(pyTimeToExp);
+  double intRate = asDouble(pyIntRate);
+  double divYield = asDouble(pyDivYield);
+  double vol = asDouble(pyVolatility);
+
+  qf::BSGreeks greeks = qf::europeanOptionBSGreeks(payoffType, spot, strike, timeToExp, intRate, divYield, vol);
+
+  return asPyDict(greeks);
+PY_END;
+}
@@ -6,13 +6,27 @@
 #include <qflib/pricers/simplepricers.hpp>
 #include <qflib/defines.hpp>
 #include <qflib/market/market.hpp>
+#include <qflib/market/marketfile.hpp>
+#include <qflib/methods/montecarlo/mcengine.hpp>
+#include <qflib/methods/pde/fdengine.hpp>
+#include <qflib/methods/lattice/latticeengine.hpp>
+#include <chrono>
+#include <memory>
+#include <qflib/threadpool.hpp>
+
+namespace {
+
+// Number of elements per task of the vectorized functions looping in the bindings
+const size_t VEC_BLOCK_SIZE = 256;
+
+} // anonymous namespace
 
 static
 PyObject*  pyQfMktList(PyObject* pyDummy, PyObject* pyArgs)
 {
 PY_BEGIN;
 
-  std::vector<std::string> ycnames = qf::market().yieldCurves().list();
+  std::vector<std::string> ycnames = qf::market().snapshot()->yieldCurves().list();
 
   // return market contents as a Python dictionary
   PyObject* ret = PyDict_New();
@@ -31,6 +45,46 @@ PY_BEGIN;
 PY_END;
 }
 
+static
+PyObject*  pyQfMktSave(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPath(NULL);
+  if (!PyArg_ParseTuple(pyArgs, "O", &pyPath))
+    return NULL;
+
+  std::string path = asString(pyPath);
+  PY_NOGIL_BEGIN;
+  qf::writeMarketFile(path, *qf::market().snapshot());
+  PY_NOGIL_END;
+  return asPyScalar(true);
+PY_END;
+}
+
+static
+PyObject*  pyQfMktLoad(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPath(NULL);
+  if (!PyArg_ParseTuple(pyArgs, "O", &pyPath))
+    return NULL;
+
+  std::string path = asString(pyPath);
+  std::unique_ptr<qf::MarketFile> file;
+  PY_NOGIL_BEGIN;
+  file = std::make_unique<qf::MarketFile>(path);
+  qf::market().update([&file](qf::SPtrMap<qf::YieldCurve>& ycmap) { file->load(ycmap); });
+  PY_NOGIL_END;
+
+  // return the names of the loaded objects as a Python dictionary
+  PyObject* ret = PyDict_New();
+  int ok = PyDict_SetItem(ret, asPyScalar("YieldCurves"), asPyList(file->yieldCurveNames()));
+  return ret;
+PY_END;
+}
+
 static
 PyObject*  pyQfYCCreate(PyObject* pyDummy, PyObject* pyArgs)
 {
@@ -44,8 +98,8 @@ PY_BEGIN;
     return NULL;
 
   std::string name = asString(pyYCName);
-  qf::Vector tmats = asVector(pyTMats);
-  qf::Vector vals = asVector(pyVals);
+  PyVectorView tmats(pyTMats);
+  PyVectorView vals(pyVals);
 
   int valtype = asInt(pyValType);
   qf::YieldCurve::InputType intype;
@@ -63,10 +117,12 @@ PY_BEGIN;
     QF_ASSERT(0, "error: unknown yield curve input type");
   }
 
-  std::pair<std::string, unsigned long> pr =
-    qf::market().yieldCurves().set(name,
-      std::make_shared<qf::YieldCurve>(tmats.begin(), tmats.end(), vals.begin(), vals.end(), intype)
+  std::pair<std::string, unsigned long> pr;
+  PY_NOGIL_BEGIN;
+  pr = qf::market().setYieldCurve(name,
+      std::make_shared<qf::YieldCurve>(tmats->begin(), tmats->end(), vals->begin(), vals->end(), intype)
     );
+  PY_NOGIL_END;
 
   std::string tag = pr.first;
   return asPyScalar(tag);
@@ -86,7 +142,7 @@ PY_BEGIN;
   std::string name = asString(pyCrvName);
   double tmat = asDouble(pyMat);
 
-  qf::SPtrYieldCurve spyc = qf::market().yieldCurves().get(name);
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(name);
   QF_ASSERT(spyc, "error: yield curve " + name + " not found");
 
   double df = spyc->discount(tmat);
@@ -110,7 +166,7 @@ PY_BEGIN;
   double T1 = asDouble(pyMat1);
   double T2 = asDouble(pyMat2);
 
-  qf::SPtrYieldCurve spyc = qf::market().yieldCurves().get(name);
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(name);
   QF_ASSERT(spyc, "error: yield curve " + name + " not found");
 
   double fdf = spyc->fwdDiscount(T1, T2);
@@ -131,7 +187,7 @@ PY_BEGIN;
   std::string name = asString(pyCrvName);
   double tmat = asDouble(pyMat);
 
-  qf::SPtrYieldCurve spyc = qf::market().yieldCurves().get(name);
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(name);
   QF_ASSERT(spyc, "error: yield curve " + name + " not found");
 
   double srate = spyc->spotRate(tmat);
@@ -155,7 +211,7 @@ PY_BEGIN;
   double T1 = asDouble(pyMat1);
   double T2 = asDouble(pyMat2);
 
-  qf::SPtrYieldCurve spyc = qf::market().yieldCurves().get(name);
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(name);
   QF_ASSERT(spyc, "error: yield curve " + name + " not found");
 
   double frate = spyc->fwdRate(T1, T2);
@@ -163,6 +219,165 @@ PY_BEGIN;
 PY_END;
 }
 
+static
+PyObject*  pyQfDiscountVec(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyCrvName(NULL);
+  PyObject* pyMats(NULL);
+  if (!PyArg_ParseTuple(pyArgs, "OO", &pyCrvName, &pyMats))
+    return NULL;
+
+  std::string name = asString(pyCrvName);
+  PyDblArrayArg tmats(pyMats, "tmats");
+
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(name);
+  QF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  size_t n = tmats.size();
+  qf::Vector df(n);
+  std::vector<double> buf;
+  PY_NOGIL_BEGIN;
+  spyc->discount(n, tmats.broadcast(n, buf), df.memptr());
+  PY_NOGIL_END;
+  return asNumpy(std::move(df));
+PY_END;
+}
+
+static
+PyObject*  pyQfFwdDiscountVec(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyCrvName(NULL);
+  PyObject* pyMats1(NULL);
+  PyObject* pyMats2(NULL);
+  if (!PyArg_ParseTuple(pyArgs, "OOO", &pyCrvName, &pyMats1, &pyMats2))
+    return NULL;
+
+  std::string name = asString(pyCrvName);
+  PyDblArrayArg tmats1(pyMats1, "tmats1");
+  PyDblArrayArg tmats2(pyMats2, "tmats2");
+  size_t n = broadcastSize(tmats1, tmats2);
+
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(name);
+  QF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  qf::Vector fdf(n);
+  std::vector<double> buf1, buf2;
+  PY_NOGIL_BEGIN;
+  spyc->fwdDiscount(n, tmats1.broadcast(n, buf1), tmats2.broadcast(n, buf2), fdf.memptr());
+  PY_NOGIL_END;
+  return asNumpy(std::move(fdf));
+PY_END;
+}
+
+static
+PyObject*  pyQfSpotRateVec(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyCrvName(NULL);
+  PyObject* pyMats(NULL);
+  if (!PyArg_ParseTuple(pyArgs, "OO", &pyCrvName, &pyMats))
+    return NULL;
+
+  std::string name = asString(pyCrvName);
+  PyDblArrayArg tmats(pyMats, "tmats");
+
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(name);
+  QF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  size_t n = tmats.size();
+  qf::Vector srate(n);
+  std::vector<double> buf;
+  PY_NOGIL_BEGIN;
+  spyc->spotRate(n, tmats.broadcast(n, buf), srate.memptr());
+  PY_NOGIL_END;
+  return asNumpy(std::move(srate));
+PY_END;
+}
+
+static
+PyObject*  pyQfFwdRateVec(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyCrvName(NULL);
+  PyObject* pyMats1(NULL);
+  PyObject* pyMats2(NULL);
+  if (!PyArg_ParseTuple(pyArgs, "OOO", &pyCrvName, &pyMats1, &pyMats2))
+    return NULL;
+
+  std::string name = asString(pyCrvName);
+  PyDblArrayArg tmats1(pyMats1, "tmats1");
+  PyDblArrayArg tmats2(pyMats2, "tmats2");
+  size_t n = broadcastSize(tmats1, tmats2);
+
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(name);
+  QF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  qf::Vector frate(n);
+  std::vector<double> buf1, buf2;
+  PY_NOGIL_BEGIN;
+  spyc->fwdRate(n, tmats1.broadcast(n, buf1), tmats2.broadcast(n, buf2), frate.memptr());
+  PY_NOGIL_END;
+  return asNumpy(std::move(frate));
+PY_END;
+}
+
+static
+PyObject*  pyQfDiscountJac(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyCrvName(NULL);
+  PyObject* pyMats(NULL);
+  if (!PyArg_ParseTuple(pyArgs, "OO", &pyCrvName, &pyMats))
+    return NULL;
+
+  std::string name = asString(pyCrvName);
+  PyVectorView tmats(pyMats);
+
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(name);
+  QF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  qf::Matrix jac;
+  PY_NOGIL_BEGIN;
+  jac = spyc->discountJacobian(tmats->n_elem, tmats->memptr()).toMatrix();
+  PY_NOGIL_END;
+  return asNumpy(std::move(jac));
+PY_END;
+}
+
+static
+PyObject*  pyQfFwdRateJac(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyCrvName(NULL);
+  PyObject* pyMats1(NULL);
+  PyObject* pyMats2(NULL);
+  if (!PyArg_ParseTuple(pyArgs, "OOO", &pyCrvName, &pyMats1, &pyMats2))
+    return NULL;
+
+  std::string name = asString(pyCrvName);
+  PyVectorView tmats1(pyMats1);
+  PyVectorView tmats2(pyMats2);
+  QF_ASSERT(tmats1->n_elem == tmats2->n_elem, "error: tmats1 and tmats2 must have the same length");
+
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(name);
+  QF_ASSERT(spyc, "error: yield curve " + name + " not found");
+
+  qf::Matrix jac;
+  PY_NOGIL_BEGIN;
+  jac = spyc->fwdRateJacobian(tmats1->n_elem, tmats1->memptr(), tmats2->memptr()).toMatrix();
+  PY_NOGIL_END;
+  return asNumpy(std::move(jac));
+PY_END;
+}
+
 
 static
 PyObject* pyQfCapFloorletBS(PyObject* pyDummy, PyObject* pyArgs)
@@ -187,7 +402,7 @@ PY_BEGIN;
   double fwdRateVol = asDouble(pyFwdRateVol);
   
   // Get yield curve from market
-  qf::SPtrYieldCurve spyc = qf::market().yieldCurves().get(ycName);
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(ycName);
   QF_ASSERT(spyc, "error: yield curve " + ycName + " not found");
   
   // Call the C++ function
@@ -197,6 +412,49 @@ PY_BEGIN;
 PY_END;
 }
 
+static
+PyObject* pyQfCapFloorletBSVec(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+
+  PyObject* pyPayType(NULL);
+  PyObject* pyYCName(NULL);
+  PyObject* pyStrikeRate(NULL);
+  PyObject* pyTimeToReset(NULL);
+  PyObject* pyTenor(NULL);
+  PyObject* pyFwdRateVol(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOO", &pyPayType, &pyYCName, &pyStrikeRate,
+                        &pyTimeToReset, &pyTenor, &pyFwdRateVol))
+    return NULL;
+
+  PyIntArrayArg payType(pyPayType, "payType");
+  std::string ycName = asString(pyYCName);
+  PyDblArrayArg strikeRate(pyStrikeRate, "strikeRate");
+  PyDblArrayArg timeToReset(pyTimeToReset, "timeToReset");
+  PyDblArrayArg tenor(pyTenor, "tenor");
+  PyDblArrayArg fwdRateVol(pyFwdRateVol, "fwdRateVol");
+  size_t n = broadcastSize(payType, strikeRate, timeToReset, tenor, fwdRateVol);
+
+  // one curve lookup for all caplets
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(ycName);
+  QF_ASSERT(spyc, "error: yield curve " + ycName + " not found");
+
+  // the caplets are priced in blocks, in parallel on threadPool()
+  qf::Vector price(n);
+  PY_NOGIL_BEGIN;
+  size_t nBlocks = (n + VEC_BLOCK_SIZE - 1) / VEC_BLOCK_SIZE;
+  qf::threadPool().parallelFor(nBlocks, [&](size_t ib) {
+    size_t iEnd = std::min(n, (ib + 1) * VEC_BLOCK_SIZE);
+    for (size_t i = ib * VEC_BLOCK_SIZE; i < iEnd; ++i)
+      price[i] = qf::capFloorletBS<double>(payType[i], *spyc, strikeRate[i], timeToReset[i], tenor[i], fwdRateVol[i]);
+  });
+  PY_NOGIL_END;
+
+  return asNumpy(std::move(price));
+PY_END;
+}
+
 static
 PyObject* pyQfCdsPV(PyObject* pyDummy, PyObject* pyArgs)
 {
@@ -220,13 +478,231 @@ PY_BEGIN;
   double payFreq = asDouble(pyPayFreq);
   
   // Get yield curve from market
-  qf::SPtrYieldCurve sprfyc = qf::market().yieldCurves().get(rfreeYC);
+  qf::SPtrYieldCurve sprfyc = qf::market().yieldCurve(rfreeYC);
   QF_ASSERT(sprfyc, "error: yield curve " + rfreeYC + " not found");
   
   // Call the C++ function
   qf::Vector result = qf::cdsPV(sprfyc, credSpread, cdsRate, recov, timeToMat, payFreq);
   
   // Convert result to NumPy array
-  return asNumpy(result);
+  return asNumpy(std::move(result));
+PY_END;
+}
+
+static
+PyObject* pyQfMcGBM(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+  PyObject* pyPayoff(NULL);
+  PyObject* pyPayoffType(NULL);
+  PyObject* pyStrike(NULL);
+  PyObject* pyFixTimes(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVol(NULL);
+  PyObject* pyYCName(NULL);
+  PyObject* pyNPaths(NULL);
+  PyObject* pySeed(NULL);
+  PyObject* pyAntithetic(NULL);
+  PyObject* pyQuasiRandom(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOOOO", &pyPayoff, &pyPayoffType, &pyStrike, &pyFixTimes,
+                        &pySpot, &pyDivYield, &pyVol, &pyYCName, &pyNPaths, &pySeed, &pyAntithetic,
+                        &pyQuasiRandom))
+    return NULL;
+
+  std::string payoffName = asString(pyPayoff);
+  int payoffType = asInt(pyPayoffType);
+  double strike = asDouble(pyStrike);
+  PyVectorView fixTimes(pyFixTimes);
+  double spot = asDouble(pySpot);
+  double divYield = asDouble(pyDivYield);
+  double vol = asDouble(pyVol);
+  std::string ycName = asString(pyYCName);
+
+  qf::McParams params;
+  long npaths = asLong(pyNPaths);
+  QF_ASSERT(npaths > 1, "the number of paths must be greater than 1");
+  params.nPaths = static_cast<size_t>(npaths);
+  params.seed = static_cast<unsigned long>(asLong(pySeed));
+  params.antithetic = asBool(pyAntithetic);
+  params.quasiRandom = asBool(pyQuasiRandom);
+
+  std::transform(payoffName.begin(), payoffName.end(), payoffName.begin(), ::toupper);
+  qf::SPtrPathPayoff payoff;
+  if (payoffName == "EUROPEAN")
+    payoff = std::make_shared<qf::EuropeanPayoff>(payoffType, strike);
+  else if (payoffName == "DIGITAL")
+    payoff = std::make_shared<qf::DigitalPayoff>(payoffType, strike);
+  else if (payoffName == "ASIAN")
+    payoff = std::make_shared<qf::AsianPayoff>(payoffType, strike);
+  else
+    QF_ASSERT(0, "error: unknown payoff " + payoffName + "; use EUROPEAN, DIGITAL or ASIAN");
+
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(ycName);
+  QF_ASSERT(spyc, "error: yield curve " + ycName + " not found");
+
+  qf::McResult res;
+  PY_NOGIL_BEGIN;
+  res = qf::mcGBM(spot, divYield, vol, spyc, *fixTimes, *payoff, params);
+  PY_NOGIL_END;
+
+  PyObject* ret = PyDict_New();
+  PyDict_SetItemString(ret, "Price", asPyScalar(res.price));
+  PyDict_SetItemString(ret, "StdErr", asPyScalar(res.stdErr));
+  PyDict_SetItemString(ret, "NPaths", asPyScalar(static_cast<long>(res.nPaths)));
+  PyDict_SetItemString(ret, "Time", asPyScalar(res.time));
+  return ret;
+PY_END;
+}
+
+static
+PyObject* pyQfFdGBM(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+  PyObject* pyPayoffType(NULL);
+  PyObject* pyAmerican(NULL);
+  PyObject* pyStrikes(NULL);
+  PyObject* pyTimesToExp(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVol(NULL);
+  PyObject* pyYCName(NULL);
+  PyObject* pyNSpaceNodes(NULL);
+  PyObject* pyNTimeSteps(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOO", &pyPayoffType, &pyAmerican, &pyStrikes, &pyTimesToExp,
+                        &pySpot, &pyDivYield, &pyVol, &pyYCName, &pyNSpaceNodes, &pyNTimeSteps))
+    return NULL;
+
+  int payoffType = asInt(pyPayoffType);
+  bool american = asBool(pyAmerican);
+  PyVectorView strikes(pyStrikes);
+  PyVectorView timesToExp(pyTimesToExp);
+  double spot = asDouble(pySpot);
+  double divYield = asDouble(pyDivYield);
+  double vol = asDouble(pyVol);
+  std::string ycName = asString(pyYCName);
+
+  qf::FdParams params;
+  long nspacenodes = asLong(pyNSpaceNodes);
+  long ntimesteps = asLong(pyNTimeSteps);
+  QF_ASSERT(nspacenodes > 0 && ntimesteps > 0, "the numbers of space nodes and time steps must be positive");
+  params.nSpaceNodes = static_cast<size_t>(nspacenodes);
+  params.nTimeSteps = static_cast<size_t>(ntimesteps);
+
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(ycName);
+  QF_ASSERT(spyc, "error: yield curve " + ycName + " not found");
+
+  size_t nStrikes = strikes->n_elem, nMats = timesToExp->n_elem;
+  std::vector<double> prices(nStrikes * nMats);
+  qf::Matrix ret(nMats, nStrikes);
+  PY_NOGIL_BEGIN;
+  qf::fdGBM(payoffType, american, spot, divYield, vol, spyc, nStrikes, strikes->memptr(),
+            nMats, timesToExp->memptr(), prices.data(), params);
+
+  // one row per maturity, one column per strike
+  for (size_t k = 0; k < nMats; ++k)
+    for (size_t j = 0; j < nStrikes; ++j)
+      ret(k, j) = prices[k * nStrikes + j];
+  PY_NOGIL_END;
+  return asNumpy(std::move(ret));
+PY_END;
+}
+
+static
+PyObject* pyQfLatticeGBM(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+  PyObject* pyPayoffTypes(NULL);
+  PyObject* pyStrikes(NULL);
+  PyObject* pyTimeToExp(NULL);
+  PyObject* pySpot(NULL);
+  PyObject* pyDivYield(NULL);
+  PyObject* pyVol(NULL);
+  PyObject* pyYCName(NULL);
+  PyObject* pyExercise(NULL);
+  PyObject* pyExerciseTimes(NULL);
+  PyObject* pyNSteps(NULL);
+  PyObject* pyLattice(NULL);
+  PyObject* pySmoothing(NULL);
+  PyObject* pyRichardson(NULL);
+
+  if (!PyArg_ParseTuple(pyArgs, "OOOOOOOOOOOOO", &pyPayoffTypes, &pyStrikes, &pyTimeToExp, &pySpot,
+                        &pyDivYield, &pyVol, &pyYCName, &pyExercise, &pyExerciseTimes, &pyNSteps,
+                        &pyLattice, &pySmoothing, &pyRichardson))
+    return NULL;
+
+  std::vector<int> payoffTypes = asIntVec(pyPayoffTypes);
+  std::vector<double> strikes = asDblVec(pyStrikes);
+  QF_ASSERT(payoffTypes.size() == strikes.size(), "error: different number of payoff types and strikes");
+  double timeToExp = asDouble(pyTimeToExp);
+  double spot = asDouble(pySpot);
+  double divYield = asDouble(pyDivYield);
+  double vol = asDouble(pyVol);
+  std::string ycName = asString(pyYCName);
+  std::string exerciseName = asString(pyExercise);
+  PyVectorView exerciseTimes(pyExerciseTimes);
+  std::string latticeName = asString(pyLattice);
+
+  qf::LatticeParams params;
+  long nsteps = asLong(pyNSteps);
+  QF_ASSERT(nsteps > 0, "the number of steps must be positive");
+  params.nSteps = static_cast<size_t>(nsteps);
+  params.smoothing = asBool(pySmoothing);
+  params.richardson = asBool(pyRichardson);
+
+  std::transform(exerciseName.begin(), exerciseName.end(), exerciseName.begin(), ::toupper);
+  qf::ExerciseType exercise;
+  if (exerciseName == "EUROPEAN")
+    exercise = qf::ExerciseType::EUROPEAN;
+  else if (exerciseName == "AMERICAN")
+    exercise = qf::ExerciseType::AMERICAN;
+  else if (exerciseName == "BERMUDAN")
+    exercise = qf::ExerciseType::BERMUDAN;
+  else
+    QF_ASSERT(0, "error: unknown exercise " + exerciseName + "; use EUROPEAN, AMERICAN or BERMUDAN");
+
+  std::transform(latticeName.begin(), latticeName.end(), latticeName.begin(), ::toupper);
+  if (latticeName == "BINOMIAL")
+    params.type = qf::LatticeType::BINOMIAL;
+  else if (latticeName == "TRINOMIAL")
+    params.type = qf::LatticeType::TRINOMIAL;
+  else
+    QF_ASSERT(0, "error: unknown lattice " + latticeName + "; use BINOMIAL or TRINOMIAL");
+
+  qf::SPtrYieldCurve spyc = qf::market().yieldCurve(ycName);
+  QF_ASSERT(spyc, "error: yield curve " + ycName + " not found");
+
+  auto start = std::chrono::steady_clock::now();
+  qf::Vector prices(strikes.size());
+  PY_NOGIL_BEGIN;
+  qf::latticeGBM(strikes.size(), payoffTypes.data(), strikes.data(), spot, timeToExp, divYield, vol,
+                 spyc, exercise, *exerciseTimes, prices.memptr(), params);
+  PY_NOGIL_END;
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  PyObject* ret = PyDict_New();
+  PyDict_SetItemString(ret, "Prices", asNumpy(std::move(prices)));
+  PyDict_SetItemString(ret, "Time", asPyScalar(elapsed.count()));
+  return ret;
 PY_END;
-}
\ No newline at end of file
+}
+
+static
+PyObject* pyQfSetNumThreads(PyObject* pyDummy, PyObject* pyArgs)
+{
+PY_BEGIN;
+  PyObject* pyNThreads(NULL);
+  if (!PyArg_ParseTuple(pyArgs, "O", &pyNThreads))
+    return NULL;
+
+  int nthreads = asInt(pyNThreads);
+  QF_ASSERT(nthreads >= 0, "the number of threads must be non-negative");
+  // waits for the parallel loops of other Python threads to complete
+  PY_NOGIL_BEGIN;
+  qf::threadPool().resize(static_cast<size_t>(nthreads));
+  PY_NOGIL_END;
+  return asPyScalar(static_cast<long>(qf::threadPool().size()));
+PY_END;
+}
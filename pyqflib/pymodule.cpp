@@ -43,16 +43,33 @@ static PyMethodDef PyQflibMethods[] =
   { "fwdPrice", pyQfFwdPrice, METH_VARARGS, "the forward price of an asset" },
   { "digiBS", pyQfDigiBS, METH_VARARGS, "price of a digital option in the Black-Scholes model." },
   { "euroBS", pyQfEuroBS, METH_VARARGS, "price of a European option in the Black-Scholes model." },
+  { "digiBSVec", pyQfDigiBSVec, METH_VARARGS, "prices of digital options in the Black-Scholes model, vectorized." },
+  { "euroBSVec", pyQfEuroBSVec, METH_VARARGS, "prices of European options in the Black-Scholes model, vectorized." },
+  { "digiBSGreeks", pyQfDigiBSGreeks, METH_VARARGS, "price and Greeks of a digital option in the Black-Scholes model." },
+  { "euroBSGreeks", pyQfEuroBSGreeks, METH_VARARGS, "price and Greeks of a European option in the Black-Scholes model." },
 // functions 2
   { "mktList", pyQfMktList, METH_VARARGS, "lists all market objects." },
   { "mktClear", pyQfMktClear, METH_VARARGS, "deletes all market objects." },
+  { "mktSave", pyQfMktSave, METH_VARARGS, "saves all market objects to a binary file." },
+  { "mktLoad", pyQfMktLoad, METH_VARARGS, "loads market objects from a binary file." },
   { "ycCreate", pyQfYCCreate, METH_VARARGS, "creates a yield curve." },
   { "discount", pyQfDiscount, METH_VARARGS, "discount factor to maturity." },
   { "fwdDiscount", pyQfFwdDiscount, METH_VARARGS, "fwd discount factor between the two maturities." },
   { "spotRate", pyQfSpotRate, METH_VARARGS, "spot rate to maturity." },
   { "fwdRate", pyQfFwdRate, METH_VARARGS, "fwd rate between the two maturities." },
+  { "discountVec", pyQfDiscountVec, METH_VARARGS, "discount factors to maturities, vectorized." },
+  { "fwdDiscountVec", pyQfFwdDiscountVec, METH_VARARGS, "fwd discount factors between maturities, vectorized." },
+  { "spotRateVec", pyQfSpotRateVec, METH_VARARGS, "spot rates to maturities, vectorized." },
+  { "fwdRateVec", pyQfFwdRateVec, METH_VARARGS, "fwd rates between maturities, vectorized." },
+  { "discountJac", pyQfDiscountJac, METH_VARARGS, "derivatives of discount factors by the yield curve input quotes." },
+  { "fwdRateJac", pyQfFwdRateJac, METH_VARARGS, "derivatives of fwd rates by the yield curve input quotes." },
   { "capFloorletBS", pyQfCapFloorletBS, METH_VARARGS, "price of a caplet or floorlet using the Black-Scholes model." },
+  { "capFloorletBSVec", pyQfCapFloorletBSVec, METH_VARARGS, "prices of caplets or floorlets using the Black-Scholes model, vectorized." },
   { "cdsPV", pyQfCdsPV, METH_VARARGS, "calculates the PV of the default leg and premium leg of a CDS." },
+  { "mcGBM", pyQfMcGBM, METH_VARARGS, "Monte Carlo price of a path-dependent option on an asset following a GBM." },
+  { "fdGBM", pyQfFdGBM, METH_VARARGS, "finite difference prices of European or American options on an asset following a GBM." },
+  { "latticeGBM", pyQfLatticeGBM, METH_VARARGS, "lattice prices of European, American or Bermudan options on an asset following a GBM." },
+  { "setNumThreads", pyQfSetNumThreads, METH_VARARGS, "sets the number of threads used by parallel computations." },
   {NULL, NULL, 0, NULL}
 };
 
@@ -8,48 +8,159 @@
 
 #include <qflib/math/matrix.hpp>
 #include <pyqflib/pycpp.hpp>   // NOTE: include the python headers last (before armadillo)
+#include <cstring>
+#include <utility>
 
-/** Converts a numpy 1-D array to an qf::Vector.
+// Returns a new reference to a numpy float64 array of ndim dimensions with the given flags,
+// converting pobj only if it is not such an array already
+static PyArrayObject* asDblArray(PyObject* pobj, int ndim, int flags, char const* caller)
+{
+  PyObject* arr = PyArray_FROM_OTF(pobj, NPY_DOUBLE, flags);
+  CASSERT(arr != nullptr, std::string(caller) + ": input object not convertible to a float64 array");
+  if (PyArray_NDIM((PyArrayObject*) arr) != ndim) {
+    Py_DECREF(arr);
+    CASSERT(false, std::string(caller) + ": input object is not " + std::to_string(ndim) + " dimensional");
+  }
+  return (PyArrayObject*) arr;
+}
+
+/** A read-only qf::Vector view of a numpy 1-D array, valid while this object lives.
+    A contiguous, aligned float64 array is used in place through an armadillo vector on its
+    memory; other inputs (lists, other dtypes, strided arrays) are converted by numpy once.
+*/
+class PyVectorView
+{
+public:
+  explicit PyVectorView(PyObject* pyVec)
+    : arr_(asDblArray(pyVec, 1, NPY_ARRAY_IN_ARRAY, "PyVectorView")),
+      vec_((double*) PyArray_DATA(arr_), (arma::uword) PyArray_DIM(arr_, 0), false, true)
+  {}
+
+  ~PyVectorView() { Py_DECREF(arr_); }
+
+  PyVectorView(PyVectorView const&) = delete;
+  PyVectorView& operator=(PyVectorView const&) = delete;
+
+  qf::Vector const& operator*() const { return vec_; }
+  qf::Vector const* operator->() const { return &vec_; }
+
+private:
+  PyArrayObject* arr_;
+  qf::Vector vec_;
+};
+
+/** A read-only qf::Matrix view of a numpy 2-D array, valid while this object lives.
+    A Fortran-ordered (column-major), aligned float64 array is used in place; others, including
+    the default C-ordered arrays, are converted by numpy once to column-major order.
+*/
+class PyMatrixView
+{
+public:
+  explicit PyMatrixView(PyObject* pyMat)
+    : arr_(asDblArray(pyMat, 2, NPY_ARRAY_IN_FARRAY, "PyMatrixView")),
+      mat_((double*) PyArray_DATA(arr_), (arma::uword) PyArray_DIM(arr_, 0),
+           (arma::uword) PyArray_DIM(arr_, 1), false, true)
+  {}
+
+  ~PyMatrixView() { Py_DECREF(arr_); }
+
+  PyMatrixView(PyMatrixView const&) = delete;
+  PyMatrixView& operator=(PyMatrixView const&) = delete;
+
+  qf::Matrix const& operator*() const { return mat_; }
+  qf::Matrix const* operator->() const { return &mat_; }
+
+private:
+  PyArrayObject* arr_;
+  qf::Matrix mat_;
+};
+
+/** Converts a numpy 1-D array to an qf::Vector, copying the elements once.
 */
 static qf::Vector asVector(PyObject* pyVec)
 {
-  return qf::Vector(asDblVec(pyVec));
+  PyVectorView view(pyVec);
+  return qf::Vector(*view);
 }
 
-/** Converts an qf::Vector to a numpy vector
+/** Converts a numpy 2-D array to an qf::Matrix, copying the elements once.
+*/
+static qf::Matrix asMatrix(PyObject* pyMat)
+{
+  PyMatrixView view(pyMat);
+  return qf::Matrix(*view);
+}
+
+// Makes the numpy array arr own the heap object owner through a capsule, deleting owner on failure
+template<typename T>
+static PyObject* setCapsuleOwner(PyObject* arr, T* owner)
+{
+  if (arr == nullptr) {
+    delete owner;
+    return nullptr;
+  }
+  PyObject* capsule = PyCapsule_New(owner, nullptr,
+    [](PyObject* cap) { delete static_cast<T*>(PyCapsule_GetPointer(cap, nullptr)); });
+  if (capsule == nullptr) {
+    delete owner;
+    Py_DECREF(arr);
+    return nullptr;
+  }
+  // steals the reference to capsule, also on failure
+  if (PyArray_SetBaseObject((PyArrayObject*) arr, capsule) < 0) {
+    Py_DECREF(arr);
+    return nullptr;
+  }
+  return arr;
+}
+
+/** Converts an qf::Vector to a numpy vector, copying the elements once
 */
 static PyObject* asNumpy(qf::Vector const & vec)
 {
-  return asPyArray(arma::conv_to<std::vector<double>>::from(vec));
+  npy_intp dims[1] = { (npy_intp) vec.n_elem };
+  PyObject* arr = PyArray_SimpleNew(1, dims, NPY_FLOAT64);
+  if (arr != nullptr && vec.n_elem > 0)
+    std::memcpy(PyArray_DATA((PyArrayObject*) arr), vec.memptr(), vec.n_elem * sizeof(double));
+  return arr;
 }
 
-/** Converts a numpy 2-D array to an qf::Matrix.
+/** Moves an qf::Vector to a numpy vector without copying the elements;
+    the array owns the vector's memory through a capsule
 */
-static qf::Matrix asMatrix(PyObject* pyMat)
+static PyObject* asNumpy(qf::Vector&& vec)
 {
-  std::vector<std::vector<double>> dvecvec = asDblVecVec(pyMat);
-  size_t nrows = dvecvec.size();
-  size_t ncols = dvecvec.front().size();
-  qf::Matrix mat(nrows, ncols);
-  for (size_t i = 0; i < nrows; ++i)
-    for (size_t j = 0; j < ncols; ++j)
-      mat(i, j) = dvecvec[i][j];
-  return mat;
+  if (vec.mem_state != 0)   // the vector does not own its memory
+    return asNumpy(static_cast<qf::Vector const&>(vec));
+  qf::Vector* owner = new qf::Vector(std::move(vec));
+  npy_intp dims[1] = { (npy_intp) owner->n_elem };
+  return setCapsuleOwner(PyArray_SimpleNewFromData(1, dims, NPY_FLOAT64, owner->memptr()), owner);
 }
 
-/** Converts an qf::Matrix to numpy
+/** Converts an qf::Matrix to a numpy array in Fortran order, copying the elements once
 */
 static PyObject* asNumpy(qf::Matrix const & mat)
 {
-  size_t nrows = mat.n_rows;
-  size_t ncols = mat.n_cols;
-  std::vector<std::vector<double>> dvecvec(nrows);
-  for (size_t i = 0; i < nrows; ++i) {
-    dvecvec[i].resize(ncols);
-    for (size_t j = 0; j < ncols; ++j)
-      dvecvec[i][j] = mat(i, j);
-  }
-  return asPyArray(dvecvec);
+  npy_intp dims[2] = { (npy_intp) mat.n_rows, (npy_intp) mat.n_cols };
+  PyObject* arr = PyArray_New(&PyArray_Type, 2, dims, NPY_FLOAT64, nullptr, nullptr, 0, 1, nullptr);
+  if (arr != nullptr && mat.n_elem > 0)
+    std::memcpy(PyArray_DATA((PyArrayObject*) arr), mat.memptr(), mat.n_elem * sizeof(double));
+  return arr;
+}
+
+/** Moves an qf::Matrix to a numpy array in Fortran order without copying the elements;
+    the array owns the matrix's memory through a capsule
+*/
+static PyObject* asNumpy(qf::Matrix&& mat)
+{
+  if (mat.mem_state != 0)   // the matrix does not own its memory
+    return asNumpy(static_cast<qf::Matrix const&>(mat));
+  qf::Matrix* owner = new qf::Matrix(std::move(mat));
+  npy_intp dims[2] = { (npy_intp) owner->n_rows, (npy_intp) owner->n_cols };
+  npy_intp strides[2] = { (npy_intp) sizeof(double), (npy_intp) (sizeof(double) * owner->n_rows) };
+  PyObject* arr = PyArray_New(&PyArray_Type, 2, dims, NPY_FLOAT64, strides, owner->memptr(), 0,
+                              NPY_ARRAY_FARRAY, nullptr);
+  return setCapsuleOwner(arr, owner);
 }
 
 #endif // PYORFLIB_PYUTILS_HPP
@@ -277,6 +277,132 @@ def euroBS(payofftype, spot, strike, timetoexp, intrate, divyield, volatility):
     return pyqflib.euroBS(payofftype, spot, strike, timetoexp, intrate, divyield, volatility)
 
 
+def digiBSVec(payofftype, spot, strike, timetoexp, intrate, divyield, volatility):
+    """Prices of European digital options in the Black-Scholes model, vectorized.
+
+    Each argument is a scalar or a 1-D array; scalars and arrays of length 1 are
+    broadcast to the common length of the arrays, as in numpy. The loop runs in C++.
+
+    Parameters
+    ----------
+    payofftype : int or array of {1, -1}
+        1 for call, -1 for put
+    spot : double or array
+        asset spot price
+    strike : double or array
+        strike price
+    timetoexp : double or array
+        time to expiration in years
+    intrate : double or array
+        interest rate, p.a. and c.c.
+    divyield : double or array
+        asset dividend yield, p.a. and c.c.
+    volatility : double or array
+        asset return volatility
+
+    Returns
+    -------
+    1-D array
+        prices of the options
+    """
+    return pyqflib.digiBSVec(payofftype, spot, strike, timetoexp, intrate, divyield, volatility)
+
+
+def euroBSVec(payofftype, spot, strike, timetoexp, intrate, divyield, volatility):
+    """Prices of European options in the Black-Scholes model, vectorized.
+
+    Each argument is a scalar or a 1-D array; scalars and arrays of length 1 are
+    broadcast to the common length of the arrays, as in numpy. The loop runs in C++.
+
+    Parameters
+    ----------
+    payofftype : int or array of {1, -1}
+        1 for call, -1 for put
+    spot : double or array
+        asset spot price
+    strike : double or array
+        strike price
+    timetoexp : double or array
+        time to expiration in years
+    intrate : double or array
+        interest rate, p.a. and c.c.
+    divyield : double or array
+        asset dividend yield, p.a. and c.c.
+    volatility : double or array
+        asset return volatility
+
+    Returns
+    -------
+    1-D array
+        prices of the options
+    """
+    return pyqflib.euroBSVec(payofftype, spot, strike, timetoexp, intrate, divyield, volatility)
+
+
+def digiBSGreeks(payofftype, spot, strike, timetoexp, intrate, divyield, volatility):
+    """Price and Greeks of a European digital option in the Black-Scholes model. 
+
+    Parameters
+    ----------
+    payofftype : {1, -1}
+        1 for call, -1 for put
+    spot : double
+        asset spot price
+    strike : double
+        strike price
+    timetoexp : double
+        time to expiration in years, positive
+    intrate : double
+        interest rate, p.a. and c.c.
+    divyield : double    
+        asset dividend yield, p.a. and c.c.
+    volatility : double
+        asset return volatility, positive
+
+    Returns
+    -------
+    dictionary
+        Price, Delta, Gamma, Vega, Theta, Rho, DivRho, Vanna, Volga, Charm
+
+    Notes
+    -----
+    1. Theta and Charm are derivatives with respect to calendar time.
+    """
+    return pyqflib.digiBSGreeks(payofftype, spot, strike, timetoexp, intrate, divyield, volatility)
+
+
+def euroBSGreeks(payofftype, spot, strike, timetoexp, intrate, divyield, volatility):
+    """Price and Greeks of a European option in the Black-Scholes model. 
+
+    Parameters
+    ----------
+    payofftype : {1, -1}
+        1 for call, -1 for put
+    spot : double
+        asset spot price
+    strike : double
+        strike price
+    timetoexp : double
+        time to expiration in years, positive
+    intrate : double
+        interest rate, p.a. and c.c.
+    divyield : double    
+        asset dividend yield, p.a. and c.c.
+    volatility : double
+        asset return volatility, positive
+
+    Returns
+    -------
+    dictionary
+        Price, Delta, Gamma, Vega, Theta, Rho, DivRho, Vanna, Volga, Charm
+
+    Notes
+    -----
+    1. Theta and Charm are derivatives with respect to calendar time.
+    """
+    return pyqflib.euroBSGreeks(payofftype, spot, strike, timetoexp, intrate, divyield, volatility)
+
+
 def ppolyIntegral(bkpoints, values, polyorder, xstart, xvec): 
     """Integral of a piecewise polynomial function from `xstart` to each point in `xvec`.
 
@@ -330,6 +456,38 @@ def mktClear():
     return pyqflib.mktClear()
 
 
+def mktSave(path):
+    """Saves all market objects to a binary file.
+
+    Parameters
+    ----------
+    path : string
+        The path of the file.
+
+    Returns
+    -------
+    TRUE
+    """
+    return pyqflib.mktSave(path)
+
+
+def mktLoad(path):
+    """Loads the market objects of a binary file saved by mktSave.
+    Objects with the same names are replaced; others are kept.
+
+    Parameters
+    ----------
+    path : string
+        The path of the file.
+
+    Returns
+    -------
+    dictionary
+        YieldCurves : list with names of the loaded yield curves
+    """
+    return pyqflib.mktLoad(path)
+
+
 def ycCreate(ycname, tmats, vals, valtype):
     """Creates a new yield curve.
 
@@ -433,6 +591,129 @@ def fwdRate(ycname, tmat1, tmat2):
     return pyqflib.fwdRate(ycname, tmat1, tmat2)
 
 
+def discountVec(ycname, tmats):
+    """Discount factors from yield curve, vectorized.
+
+    Parameters
+    ----------
+    ycname : str
+        name of the yield curve
+    tmats : double or 1-D array
+        times to maturity of the discount factors, in years
+
+    Returns
+    -------
+    1-D array
+        discount factors
+    """
+    return pyqflib.discountVec(ycname, tmats)
+
+
+def fwdDiscountVec(ycname, tmats1, tmats2):
+    """Forward discount factors from yield curve, vectorized.
+
+    Scalars and arrays of length 1 are broadcast to the length of the other argument.
+
+    Parameters
+    ----------
+    ycname : str
+        name of the yield curve
+    tmats1 : double or 1-D array
+        times to reset of the forward discount factors, in years
+    tmats2 : double or 1-D array
+        times to maturity of the forward discount factors, in years
+
+    Returns
+    -------
+    1-D array
+        forward discount factors
+    """
+    return pyqflib.fwdDiscountVec(ycname, tmats1, tmats2)
+
+
+def spotRateVec(ycname, tmats):
+    """Spot interest rates from yield curve, vectorized.
+
+    Parameters
+    ----------
+    ycname : str
+        name of the yield curve
+    tmats : double or 1-D array
+        times to maturity of the interest rates, in years
+
+    Returns
+    -------
+    1-D array
+        spot rates
+    """
+    return pyqflib.spotRateVec(ycname, tmats)
+
+
+def fwdRateVec(ycname, tmats1, tmats2):
+    """Forward interest rates from yield curve, vectorized.
+
+    Scalars and arrays of length 1 are broadcast to the length of the other argument.
+
+    Parameters
+    ----------
+    ycname : str
+        name of the yield curve
+    tmats1 : double or 1-D array
+        times to reset of the forward rates, in years
+    tmats2 : double or 1-D array
+        times to maturity of the forward rates, in years
+
+    Returns
+    -------
+    1-D array
+        forward rates
+    """
+    return pyqflib.fwdRateVec(ycname, tmats1, tmats2)
+
+
+def discountJac(ycname, tmats):
+    """Derivatives of discount factors by the input quotes of the yield curve.
+
+    The derivatives are exact, computed in closed form from the piecewise constant
+    forward rates, without rebuilding the curve.
+
+    Parameters
+    ----------
+    ycname : str
+        name of the yield curve
+    tmats : list or 1-D array
+        times to maturity of the discount factors, in years
+
+    Returns
+    -------
+    2-D array
+        the derivative of the discount factor to tmats[i] by the j-th input quote,
+        in row i and column j
+    """
+    return pyqflib.discountJac(ycname, tmats)
+
+
+def fwdRateJac(ycname, tmats1, tmats2):
+    """Derivatives of forward rates by the input quotes of the yield curve.
+
+    Parameters
+    ----------
+    ycname : str
+        name of the yield curve
+    tmats1 : list or 1-D array
+        times to reset of the forward rates, in years
+    tmats2 : list or 1-D array
+        times to maturity of the forward rates, in years
+
+    Returns
+    -------
+    2-D array
+        the derivative of the forward rate from tmats1[i] to tmats2[i] by the j-th input
+        quote, in row i and column j
+    """
+    return pyqflib.fwdRateJac(ycname, tmats1, tmats2)
+
+
 def capFloorletBS(payType, ycName, strikeRate, timeToReset, tenor, fwdRateVol):
     """Price of a caplet or floorlet using the Black-Scholes model.
 
@@ -458,6 +739,35 @@ def capFloorletBS(payType, ycName, strikeRate, timeToReset, tenor, fwdRateVol):
     """
     return pyqflib.capFloorletBS(payType, ycName, strikeRate, timeToReset, tenor, fwdRateVol)
 
+
+def capFloorletBSVec(payType, ycName, strikeRate, timeToReset, tenor, fwdRateVol):
+    """Prices of caplets or floorlets using the Black-Scholes model, vectorized.
+
+    Each argument except ycName is a scalar or a 1-D array; scalars and arrays of
+    length 1 are broadcast to the common length of the arrays, as in numpy.
+
+    Parameters
+    ----------
+    payType : int or array of {1, -1}
+        1 for caplet, -1 for floorlet
+    ycName : str
+        name of the yield curve
+    strikeRate : double or array
+        fixed strike rate, annualized and with simple compounding
+    timeToReset : double or array
+        time to the reset (fixing) of the future rate, in years
+    tenor : double or array
+        time span between reset and payment, in years
+    fwdRateVol : double or array
+        annualized volatility of the forward rate
+
+    Returns
+    -------
+    1-D array
+        prices of the caplets or floorlets
+    """
+    return pyqflib.capFloorletBSVec(payType, ycName, strikeRate, timeToReset, tenor, fwdRateVol)
+
 def cdsPV(rfreeYC, credSpread, cdsRate, recov, timeToMat, payFreq):
     """Present value of the default leg and premium leg of a CDS.
 Parameters
@@ -485,4 +795,158 @@ Notes
 1. The number of payments is ceiling(timeToMat*payFreq) with any stub period at the beginning.
 2. Survival probabilities are always non-negative for non-zero recovery.
 """
-    return pyqflib.cdsPV(rfreeYC, credSpread, cdsRate, recov, timeToMat, payFreq)
\ No newline at end of file
+    return pyqflib.cdsPV(rfreeYC, credSpread, cdsRate, recov, timeToMat, payFreq)
+
+
+def mcGBM(payoff, payofftype, strike, fixtimes, spot, divyield, volatility, ycname,
+          npaths=100000, seed=42, antithetic=False, quasirandom=False):
+    """Monte Carlo price of a path-dependent option on an asset following a geometric Brownian motion.
+
+    Parameters
+    ----------
+    payoff : {'EUROPEAN', 'DIGITAL', 'ASIAN'}
+        payoff on the price at the last fixing, or on the arithmetic average of all fixings (ASIAN)
+    payofftype : {1, -1}
+        1 for call, -1 for put
+    strike : double
+        strike price
+    fixtimes : list(double) or 1D numpy array
+        fixing times in years, positive and increasing; the payoff is paid at the last one
+    spot : double
+        asset spot price
+    divyield : double
+        asset dividend yield, p.a. and c.c.
+    volatility : double
+        asset return volatility
+    ycname : str
+        name of the yield curve providing the drift and the discounting
+    npaths : int
+        number of simulated paths
+    seed : int
+        seed of the random streams
+    antithetic : bool
+        if True, paths are simulated in antithetic pairs
+    quasirandom : bool
+        if True, paths are built from a scrambled Sobol sequence by Brownian bridge
+
+    Returns
+    -------
+    dictionary
+        Price, StdErr, NPaths, Time (wall clock seconds)
+
+    Notes
+    -----
+    1. The paths are simulated on all threads set by setNumThreads; the results do not depend on
+       the number of threads.
+    2. With quasirandom=True, StdErr is the sample standard error, which overstates the error.
+    """
+    return pyqflib.mcGBM(payoff, payofftype, strike, fixtimes, spot, divyield, volatility, ycname,
+                         npaths, seed, antithetic, quasirandom)
+
+
+def fdGBM(payofftype, american, strikes, timestoexp, spot, divyield, volatility, ycname,
+          nspacenodes=400, ntimesteps=200):
+    """Finite difference prices of European or American options on an asset following a geometric Brownian motion.
+
+    Parameters
+    ----------
+    payofftype : {1, -1}
+        1 for call, -1 for put
+    american : bool
+        True for American exercise, False for European
+    strikes : list(double) or 1D numpy array
+        strike prices
+    timestoexp : list(double) or 1D numpy array
+        times to expiration in years
+    spot : double
+        asset spot price
+    divyield : double
+        asset dividend yield, p.a. and c.c.
+    volatility : double
+        asset return volatility
+    ycname : str
+        name of the yield curve providing the drift and the discounting
+    nspacenodes : int
+        number of nodes of the price grid
+    ntimesteps : int
+        number of time steps to each expiration
+
+    Returns
+    -------
+    2D numpy array
+        prices, one row per time to expiration and one column per strike
+
+    Notes
+    -----
+    1. All strikes of one expiration are priced from a single solve of the Crank-Nicolson scheme;
+       the expirations are solved in parallel on the threads set by setNumThreads.
+    """
+    return pyqflib.fdGBM(payofftype, american, strikes, timestoexp, spot, divyield, volatility, ycname,
+                         nspacenodes, ntimesteps)
+
+
+def latticeGBM(payofftypes, strikes, timetoexp, spot, divyield, volatility, ycname, exercise,
+               exercisetimes=[], nsteps=500, lattice='BINOMIAL', smoothing=False, richardson=False):
+    """Lattice prices of European, American or Bermudan options with the same expiration
+    on an asset following a geometric Brownian motion.
+
+    Parameters
+    ----------
+    payofftypes : list(int) or 1D numpy array
+        1 for call, -1 for put, one per option
+    strikes : list(double) or 1D numpy array
+        strike prices, one per option
+    timetoexp : double
+        time to expiration in years
+    spot : double
+        asset spot price
+    divyield : double
+        asset dividend yield, p.a. and c.c.
+    volatility : double
+        asset return volatility
+    ycname : str
+        name of the yield curve providing the drift and the discounting
+    exercise : {'EUROPEAN', 'AMERICAN', 'BERMUDAN'}
+        exercise style
+    exercisetimes : list(double) or 1D numpy array
+        exercise times in years of Bermudan options; ignored otherwise
+    nsteps : int
+        number of time steps
+    lattice : {'BINOMIAL', 'TRINOMIAL'}
+        Cox-Ross-Rubinstein binomial or Kamrad-Ritchken trinomial lattice
+    smoothing : bool
+        if True, the values one step before expiration are Black-Scholes prices
+    richardson : bool
+        if True, the prices are extrapolated from nsteps and nsteps/2 steps
+
+    Returns
+    -------
+    dictionary
+        Prices (1D numpy array), Time (wall clock seconds)
+
+    Notes
+    -----
+    1. All options are priced on one lattice, in blocks on the threads set by setNumThreads.
+    """
+    return pyqflib.latticeGBM(payofftypes, strikes, timetoexp, spot, divyield, volatility, ycname,
+                              exercise, exercisetimes, nsteps, lattice, smoothing, richardson)
+
+
+def setNumThreads(nthreads):
+    """Sets the number of threads used by parallel computations.
+
+    The numerical methods and the vectorized functions run on this pool of native threads.
+    The pricing, curve and market file functions release the GIL while computing, so they
+    can also be called concurrently from several Python threads.
+
+    Parameters
+    ----------
+    nthreads : int
+        number of threads, including the calling one; 0 for the number of hardware threads
+
+    Returns
+    -------
+    int
+        the number of threads
+    """
+    return pyqflib.setNumThreads(nthreads)
@@ -8,14 +8,14 @@
 
 /** version string */
 #ifdef NDEBUG
-#define QF_VERSION_STRING "0.7.0"
+#define QF_VERSION_STRING "0.8.0"
 #else
-#define QF_VERSION_STRING "0.7.0-debug"
+#define QF_VERSION_STRING "0.8.0-debug"
 #endif
 
 /** version numbers */
 #define QF_VERSION_MAJOR 0
-#define QF_VERSION_MINOR 7
+#define QF_VERSION_MINOR 8
 #define QF_VERSION_REVISION 0
 
 /** Macro for namespaces */
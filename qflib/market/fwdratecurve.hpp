@@ -0,0 +1,197 @@
+/**
+@file  fwdratecurve.hpp
+@brief The forward rate bootstrap and integrals shared by YieldCurve and YieldCurveT
+*/
+
+#ifndef QF_FWDRATECURVE_HPP
+#define QF_FWDRATECURVE_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <qflib/math/interpol/breakpointindex.hpp>
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+BEGIN_NAMESPACE(qf)
+
+/** The type of the quotes a yield curve is built from; also known as YieldCurve::InputType */
+enum class YieldCurveInputType
+{
+  SPOTRATE,
+  FWDRATE,
+  ZEROBOND
+};
+
+/** Piecewise constant, right-continuous forward rates bootstrapped from yield curve quotes,
+    with their integrals from 0, which give the discount factors and rates in O(log n).
+    The rates and integrals are of number type T: double in YieldCurve, any type in YieldCurveT.
+    Both curves use this one implementation, so YieldCurveT<double> gives the same results as
+    YieldCurve bit for bit. The maturities are always double.
+*/
+template<typename T>
+class FwdRateCurve
+{
+public:
+  /** Ctor from the maturities and the quotes [quoteBegin, quoteEnd) of type intype */
+  template<typename YITER>
+  FwdRateCurve(std::vector<double> const& tMats, YITER quoteBegin, YITER quoteEnd,
+               YieldCurveInputType intype);
+
+  /** Ctor from forward rates already bootstrapped, as returned by times() and rates() */
+  FwdRateCurve(std::vector<double> times, std::vector<T> rates);
+
+  /** Returns the start times of the forward rate periods; the first is 0 */
+  std::vector<double> const& times() const { return times_; }
+
+  /** Returns the forward rates of the periods starting at times() */
+  std::vector<T> const& rates() const { return rates_; }
+
+  /** Returns the index of the forward rate period containing t >= 0 */
+  size_t periodIndex(double t) const
+  {
+    return std::max<ptrdiff_t>(0, timesIndex_.find(times_.data(), times_.size(), t));
+  }
+
+  /** Returns the integral of the forward rates from 0 to t */
+  T integral(double t) const;
+
+  /** Returns the integral of the forward rates from t1 to t2 */
+  T integral(double t1, double t2) const;
+
+private:
+  // Fills cumInt_ and timesIndex_ from times_ and rates_
+  void buildIntegrals();
+
+  std::vector<double> times_;     // start time of each forward rate, times_[0] = 0
+  std::vector<T> rates_;          // the forward rates
+  std::vector<T> cumInt_;         // integral of the forward rates from 0 to times_[i]
+  BreakpointIndex timesIndex_;    // search accelerator for times_
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline implementations
+
+template<typename T>
+template<typename YITER>
+FwdRateCurve<T>::FwdRateCurve(std::vector<double> const& tMats, YITER quoteBegin, YITER quoteEnd,
+                              YieldCurveInputType intype)
+{
+  using std::log;
+  using std::to_string;
+
+  std::ptrdiff_t n = tMats.size();
+  QF_ASSERT(n == quoteEnd - quoteBegin, "YieldCurve: different number of maturities and rates");
+  QF_ASSERT(n > 0, "YieldCurve: no maturities");
+  QF_ASSERT(tMats[0] > 0.0, "YieldCurve: maturities must be positive");
+  QF_ASSERT(std::adjacent_find(tMats.begin(), tMats.end(), std::greater_equal<double>()) == tMats.end(),
+    "YieldCurve: maturities must be increasing");
+
+  // the forward rate i starts at the previous maturity
+  times_.resize(n);
+  rates_.resize(n);
+  double T1 = 0.0;                  // the observation time is t = 0
+  YITER it = quoteBegin;
+  switch (intype) {
+  case YieldCurveInputType::ZEROBOND: {
+    T p1 = 1.0;                     // bond maturing at T1
+    for (ptrdiff_t i = 0; i < n; ++i, ++it) {
+      double T2 = tMats[i];
+      T p2 = *it;
+      QF_ASSERT(p2 <= 1.0 && p2 > 0, "YieldCurve: zero bond prices must in (0,1]");
+      T fwdrate = log(p1 / p2);
+      QF_ASSERT(fwdrate >= 0.0,
+        "YieldCurve: negative fwd rate between T1 = " + to_string(T1) + " and T2 = " + to_string(T2));
+      fwdrate /= (T2 - T1);
+      times_[i] = T1;
+      rates_[i] = fwdrate;
+      p1 = p2;
+      T1 = T2;
+    }
+    break;
+  }
+  case YieldCurveInputType::SPOTRATE: {
+    T R1 = *it;
+    times_[0] = 0.0;
+    rates_[0] = R1;
+    T1 = tMats[0];
+    for (ptrdiff_t i = 1; i < n; ++i) {
+      double T2 = tMats[i];
+      T R2 = *++it;
+      T F = R2 * T2 - R1 * T1;
+      QF_ASSERT(F >= 0.0,
+        "YieldCurve: negative fwd rate between T1 = " + to_string(T1) + " and T2 = " + to_string(T2));
+      F /= (T2 - T1);
+      times_[i] = T1;
+      rates_[i] = F;
+      T1 = T2;
+      R1 = R2;
+    }
+    break;
+  }
+  case YieldCurveInputType::FWDRATE:
+    for (ptrdiff_t i = 0; i < n; ++i, ++it) {
+      double T2 = tMats[i];
+      QF_ASSERT(*it >= 0.0,
+        "YieldCurve: negative fwd rate between T1 = " + to_string(T1) + " and T2 = " + to_string(T2));
+      times_[i] = T1;
+      rates_[i] = *it;
+      T1 = T2;
+    }
+    break;
+  default:
+    QF_ASSERT(0, "error: unknown yield curve input type");
+  }
+
+  buildIntegrals();
+}
+
+template<typename T>
+FwdRateCurve<T>::FwdRateCurve(std::vector<double> times, std::vector<T> rates)
+: times_(std::move(times)), rates_(std::move(rates))
+{
+  QF_ASSERT(times_.size() == rates_.size(), "YieldCurve: different number of forward rate times and rates");
+  QF_ASSERT(!times_.empty() && times_[0] == 0.0, "YieldCurve: forward rate times must start at 0");
+  QF_ASSERT(std::adjacent_find(times_.begin(), times_.end(), std::greater_equal<double>()) == times_.end(),
+    "YieldCurve: forward rate times must be increasing");
+  buildIntegrals();
+}
+
+template<typename T>
+void FwdRateCurve<T>::buildIntegrals()
+{
+  size_t n = times_.size();
+  cumInt_.resize(n);
+  T cum = 0.0;
+  for (size_t i = 0; i < n; ++i) {
+    if (i > 0)
+      cum += rates_[i - 1] * (times_[i] - times_[i - 1]);
+    cumInt_[i] = cum;
+  }
+  timesIndex_.build(times_.data(), n);
+}
+
+template<typename T>
+T FwdRateCurve<T>::integral(double t) const
+{
+  // the last rate at or before t; times_[0] = 0 <= t
+  size_t i = periodIndex(t);
+  return cumInt_[i] + rates_[i] * (t - times_[i]);
+}
+
+template<typename T>
+T FwdRateCurve<T>::integral(double t1, double t2) const
+{
+  size_t i1 = periodIndex(t1);
+  size_t i2 = periodIndex(t2);
+  if (i1 == i2)
+    return rates_[i1] * (t2 - t1);   // within one period, without cancellation
+  return (cumInt_[i2] + rates_[i2] * (t2 - times_[i2])) - (cumInt_[i1] + rates_[i1] * (t1 - times_[i1]));
+}
+
+END_NAMESPACE(qf)
+
+#endif // QF_FWDRATECURVE_HPP
@@ -13,10 +13,49 @@ Market& Market::instance()
   return theMarket;
 }
 
+Market::Market() : version_(0)
+{
+  publish(SPtrMap<YieldCurve>());
+}
+
+SPtrMarketSnapshot Market::snapshot() const
+{
+#ifdef __cpp_lib_atomic_shared_ptr
+  return current_.load(std::memory_order_acquire);
+#else
+  return std::atomic_load(&current_);
+#endif
+}
+
+void Market::publish(SPtrMap<YieldCurve> ycmap)
+{
+  SPtrMarketSnapshot snap = std::make_shared<const MarketSnapshot>(std::move(ycmap), ++version_);
+#ifdef __cpp_lib_atomic_shared_ptr
+  current_.store(std::move(snap), std::memory_order_release);
+#else
+  std::atomic_store(&current_, std::move(snap));
+#endif
+}
+
+std::pair<std::string, unsigned long> Market::setYieldCurve(std::string const& name, SPtrYieldCurve const& spyc)
+{
+  std::pair<std::string, unsigned long> ret;
+  update([&](SPtrMap<YieldCurve>& ycmap) { ret = ycmap.set(name, spyc); });
+  return ret;
+}
+
+void Market::update(std::function<void(SPtrMap<YieldCurve>&)> const& func)
+{
+  std::lock_guard<std::mutex> lock(writeMutex_);
+  SPtrMap<YieldCurve> ycmap(snapshot()->yieldCurves());
+  func(ycmap);
+  publish(std::move(ycmap));
+}
 
 void Market::clear()
 {
-  ycmap_.clear();
+  std::lock_guard<std::mutex> lock(writeMutex_);
+  publish(SPtrMap<YieldCurve>());
 }
 
 // The helper function
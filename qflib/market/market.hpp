@@ -10,9 +10,41 @@
 #include <qflib/exception.hpp>
 #include <qflib/sptrmap.hpp>
 #include <qflib/market/yieldcurve.hpp>
+#include <atomic>
+#include <functional>
+#include <mutex>
 
 BEGIN_NAMESPACE(qf)
 
+/** An immutable set of market objects, as published by the Market.
+    Pricing code takes a snapshot once and reads all its objects from it, without locks and
+    unaffected by later updates of the market.
+*/
+class MarketSnapshot
+{
+public:
+  /** Ctor from the yield curves map and the snapshot version */
+  MarketSnapshot(SPtrMap<YieldCurve> ycmap, unsigned long version)
+    : ycmap_(std::move(ycmap)), version_(version) {}
+
+  /** Returns the yield curves map */
+  SPtrMap<YieldCurve> const& yieldCurves() const { return ycmap_; }
+
+  /** Returns the version of the snapshot; every publication increments it */
+  unsigned long version() const { return version_; }
+
+private:
+  SPtrMap<YieldCurve> ycmap_;
+  unsigned long version_;
+};
+
+using SPtrMarketSnapshot = std::shared_ptr<const MarketSnapshot>;
+
+/** The market holds the current snapshot of the market objects.
+    Readers get it with snapshot(), a lock-free atomic load of a shared pointer.
+    Writers are serialized: each update copies the current maps, modifies the copy and publishes
+    it as the new snapshot with an atomic store, so readers never see a partial update.
+*/
 class Market
 {
 public:
@@ -20,16 +52,32 @@ public:
   /** Returns the unique instance */
   static Market& instance();
 
+  /** Returns the current snapshot */
+  SPtrMarketSnapshot snapshot() const;
+
+  /** Returns the yield curve with this name in the current snapshot, or null if there is none */
+  SPtrYieldCurve yieldCurve(std::string const& name) const { return snapshot()->yieldCurves().get(name); }
+
+  /** Returns the yield curve with this handle in the current snapshot, or null if there is none;
+      handles from SPtrMap::handle() stay valid across snapshots until clear(), and find nothing after it
+  */
+  SPtrYieldCurve yieldCurve(SPtrMap<YieldCurve>::handle_type h) const { return snapshot()->yieldCurves().get(h); }
+
+  /** Stores the yield curve under this name and publishes a new snapshot
+      Returns the name and the version number of the curve
+  */
+  std::pair<std::string, unsigned long> setYieldCurve(std::string const& name, SPtrYieldCurve const& spyc);
+
+  /** Applies func to a copy of the yield curves map, and publishes the result as one new snapshot */
+  void update(std::function<void(SPtrMap<YieldCurve>&)> const& func);
+
   /** Clears the market of all objects */
   void clear();
 
-  /** Returns the yield curves map */
-  SPtrMap<YieldCurve>& yieldCurves() { return ycmap_; }
-
 private:
 
   /** allow private default ctor */
-  Market() {}
+  Market();
 
   /** forbid copy ctor, copy-assignment, move ctor and move assignment */
   Market(Market const& rhs) = delete;
@@ -37,8 +85,17 @@ private:
   Market(Market&& rhs) = delete;
   Market& operator=(Market&&) = delete;
 
+  // Publishes a new snapshot with this map; writeMutex_ must be held
+  void publish(SPtrMap<YieldCurve> ycmap);
+
   // state
-  SPtrMap<YieldCurve> ycmap_;
+  std::mutex writeMutex_;   // serializes the writers
+  unsigned long version_;   // version of the current snapshot
+#ifdef __cpp_lib_atomic_shared_ptr
+  std::atomic<SPtrMarketSnapshot> current_;
+#else
+  SPtrMarketSnapshot current_;   // accessed with std::atomic_load and std::atomic_store
+#endif
 };
 
 /** Free function returning the market singleton */
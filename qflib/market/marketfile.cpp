@@ -0,0 +1,241 @@
+/**
+@file  marketfile.cpp
+@brief Implementation of the binary market snapshot files
+*/
+
+#include <qflib/market/marketfile.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+BEGIN_NAMESPACE(qf)
+
+namespace {
+
+const char FILE_MAGIC[8] = { 'Q', 'F', 'M', 'K', 'T', 'S', 'N', 'P' };
+const std::uint32_t FILE_BYTE_ORDER = 0x01020304;
+const std::uint32_t FILE_FORMAT_VERSION = 3;
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t byteOrder;       // FILE_BYTE_ORDER in the byte order of the writer
+  std::uint32_t formatVersion;
+  std::uint64_t marketVersion;   // version of the snapshot
+  std::uint64_t nCurves;
+};
+
+struct FileEntry
+{
+  std::uint64_t nameOffset;
+  std::uint64_t nameLength;
+  std::uint64_t dataOffset;      // nPoints forward rate times, then rates, maturities and quotes
+  std::uint64_t nPoints;
+  std::uint64_t inputType;       // the YieldCurve::InputType of the quotes
+  std::uint64_t version;
+};
+
+// Rounds n up to a multiple of 8
+std::uint64_t align8(std::uint64_t n)
+{
+  return (n + 7) & ~std::uint64_t(7);
+}
+
+} // anonymous namespace
+
+void writeMarketFile(std::string const& path, MarketSnapshot const& snap)
+{
+  SPtrMap<YieldCurve> const& ycmap = snap.yieldCurves();
+  std::vector<std::string> names = ycmap.list();
+  size_t n = names.size();
+
+  // layout: header, directory, names, then the curve data aligned to 8 bytes
+  std::vector<FileEntry> entries(n);
+  std::uint64_t offset = sizeof(FileHeader) + n * sizeof(FileEntry);
+  for (size_t i = 0; i < n; ++i) {
+    entries[i].nameOffset = offset;
+    entries[i].nameLength = names[i].size();
+    offset += names[i].size();
+  }
+  offset = align8(offset);
+  std::uint64_t namesEnd = offset;
+  std::vector<SPtrYieldCurve> curves(n);
+  for (size_t i = 0; i < n; ++i) {
+    curves[i] = ycmap.get(names[i]);
+    entries[i].dataOffset = offset;
+    entries[i].nPoints = curves[i]->maturities().size();
+    entries[i].inputType = static_cast<std::uint64_t>(curves[i]->inputType());
+    entries[i].version = ycmap.version(names[i]);
+    offset += 4 * entries[i].nPoints * sizeof(double);
+  }
+
+  FileHeader header;
+  std::memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+  header.byteOrder = FILE_BYTE_ORDER;
+  header.formatVersion = FILE_FORMAT_VERSION;
+  header.marketVersion = snap.version();
+  header.nCurves = n;
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  QF_ASSERT(out, "writeMarketFile: cannot open " + path);
+  out.write(reinterpret_cast<char const*>(&header), sizeof(header));
+  out.write(reinterpret_cast<char const*>(entries.data()), n * sizeof(FileEntry));
+  std::uint64_t written = sizeof(FileHeader) + n * sizeof(FileEntry);
+  for (size_t i = 0; i < n; ++i) {
+    out.write(names[i].data(), names[i].size());
+    written += names[i].size();
+  }
+  char const zeros[8] = {};
+  out.write(zeros, namesEnd - written);
+  for (size_t i = 0; i < n; ++i) {
+    std::vector<double> const& times = curves[i]->fwdRateTimes();
+    std::vector<double> const& rates = curves[i]->fwdRates();
+    std::vector<double> const& tMats = curves[i]->maturities();
+    std::vector<double> const& quotes = curves[i]->quotes();
+    out.write(reinterpret_cast<char const*>(times.data()), times.size() * sizeof(double));
+    out.write(reinterpret_cast<char const*>(rates.data()), rates.size() * sizeof(double));
+    out.write(reinterpret_cast<char const*>(tMats.data()), tMats.size() * sizeof(double));
+    out.write(reinterpret_cast<char const*>(quotes.data()), quotes.size() * sizeof(double));
+  }
+  QF_ASSERT(out, "writeMarketFile: error writing " + path);
+}
+
+MarketFile::MarketFile(std::string const& path)
+  : data_(nullptr), size_(0), handle_(nullptr), version_(0)
+{
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL, NULL);
+  QF_ASSERT(file != INVALID_HANDLE_VALUE, "MarketFile: cannot open " + path);
+  LARGE_INTEGER fileSize;
+  BOOL ok = GetFileSizeEx(file, &fileSize);
+  handle_ = ok ? CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL) : NULL;
+  CloseHandle(file);
+  QF_ASSERT(handle_ != NULL, "MarketFile: cannot map " + path);
+  size_ = static_cast<size_t>(fileSize.QuadPart);
+  data_ = MapViewOfFile(handle_, FILE_MAP_READ, 0, 0, 0);
+  if (data_ == NULL) {
+    CloseHandle(handle_);
+    QF_ASSERT(0, "MarketFile: cannot map " + path);
+  }
+#else
+  int fd = open(path.c_str(), O_RDONLY);
+  QF_ASSERT(fd >= 0, "MarketFile: cannot open " + path);
+  struct stat st;
+  if (fstat(fd, &st) == 0 && st.st_size > 0) {
+    size_ = static_cast<size_t>(st.st_size);
+    data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+  close(fd);
+  if (data_ == MAP_FAILED)
+    data_ = nullptr;
+  QF_ASSERT(data_, "MarketFile: cannot map " + path);
+#endif
+
+  try {
+    char const* base = static_cast<char const*>(data_);
+    QF_ASSERT(size_ >= sizeof(FileHeader), "MarketFile: file too short");
+    FileHeader header;
+    std::memcpy(&header, base, sizeof(header));
+    QF_ASSERT(std::memcmp(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC)) == 0,
+              "MarketFile: not a market snapshot file");
+    QF_ASSERT(header.byteOrder == FILE_BYTE_ORDER, "MarketFile: file written with another byte order");
+    QF_ASSERT(header.formatVersion == FILE_FORMAT_VERSION, "MarketFile: unsupported format version");
+    QF_ASSERT(header.nCurves <= (size_ - sizeof(FileHeader)) / sizeof(FileEntry), "MarketFile: corrupt directory");
+    version_ = static_cast<unsigned long>(header.marketVersion);
+
+    entries_.reserve(header.nCurves);
+    for (size_t i = 0; i < header.nCurves; ++i) {
+      FileEntry fe;
+      std::memcpy(&fe, base + sizeof(FileHeader) + i * sizeof(FileEntry), sizeof(fe));
+      QF_ASSERT(fe.nameOffset <= size_ && fe.nameLength > 0 && fe.nameLength <= size_ - fe.nameOffset,
+                "MarketFile: corrupt name of entry " + std::to_string(i));
+      QF_ASSERT(fe.dataOffset % sizeof(double) == 0 && fe.dataOffset <= size_ && fe.nPoints > 0
+                && fe.nPoints <= (size_ - fe.dataOffset) / (4 * sizeof(double)),
+                "MarketFile: corrupt data of entry " + std::to_string(i));
+      QF_ASSERT(fe.inputType <= static_cast<std::uint64_t>(YieldCurve::InputType::ZEROBOND),
+                "MarketFile: unknown input type of entry " + std::to_string(i));
+      auto e = std::make_unique<Entry>();
+      e->name.assign(base + fe.nameOffset, fe.nameLength);
+      e->intype = static_cast<YieldCurve::InputType>(fe.inputType);
+      e->nPoints = fe.nPoints;
+      e->times = reinterpret_cast<double const*>(base + fe.dataOffset);
+      e->rates = e->times + fe.nPoints;
+      e->tMats = e->rates + fe.nPoints;
+      e->quotes = e->tMats + fe.nPoints;
+      e->version = static_cast<unsigned long>(fe.version);
+      index_.emplace(e->name, i);
+      entries_.push_back(std::move(e));
+    }
+  }
+  catch (...) {
+    unmap();
+    throw;
+  }
+}
+
+MarketFile::~MarketFile()
+{
+  unmap();
+}
+
+void MarketFile::unmap()
+{
+  if (!data_)
+    return;
+#ifdef _WIN32
+  UnmapViewOfFile(data_);
+  CloseHandle(handle_);
+#else
+  munmap(const_cast<void*>(data_), size_);
+#endif
+  data_ = nullptr;
+}
+
+std::vector<std::string> MarketFile::yieldCurveNames() const
+{
+  std::vector<std::string> names;
+  for (auto const& e : entries_)
+    names.push_back(e->name);
+  return names;
+}
+
+SPtrYieldCurve MarketFile::build(Entry const& e) const
+{
+  std::call_once(e.built, [&e]() {
+    // the saved forward rates, without rerunning the bootstrap; the inputs are for the Jacobians
+    e.curve = std::make_shared<YieldCurve>(e.tMats, e.tMats + e.nPoints, e.quotes, e.quotes + e.nPoints,
+                                           e.intype, std::vector<double>(e.times, e.times + e.nPoints),
+                                           std::vector<double>(e.rates, e.rates + e.nPoints));
+  });
+  return e.curve;
+}
+
+SPtrYieldCurve MarketFile::yieldCurve(std::string const& name) const
+{
+  std::string nm = trim(name);
+  std::transform(nm.begin(), nm.end(), nm.begin(), ::toupper);
+  auto it = index_.find(nm);
+  return it == index_.end() ? SPtrYieldCurve() : build(*entries_[it->second]);
+}
+
+void MarketFile::load(SPtrMap<YieldCurve>& ycmap) const
+{
+  for (auto const& e : entries_)
+    ycmap.set(e->name, build(*e), e->version);
+}
+
+END_NAMESPACE(qf)
@@ -0,0 +1,89 @@
+/**
+@file  marketfile.hpp
+@brief Binary market snapshot files, memory-mapped for reading
+*/
+
+#ifndef QF_MARKETFILE_HPP
+#define QF_MARKETFILE_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <qflib/market/market.hpp>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+BEGIN_NAMESPACE(qf)
+
+/** Writes the objects of a market snapshot to a binary file.
+    The file holds a header, a directory with one fixed-size entry per yield curve, the curve
+    names and the forward rate times and rates of each curve with its input type, maturities and
+    quotes, and their SPtrMap versions.
+    Numbers are stored in the native byte order, which is checked when the file is opened.
+*/
+void writeMarketFile(std::string const& path, MarketSnapshot const& snap);
+
+/** A market snapshot file opened for reading.
+    The file is memory-mapped: opening it only reads the header and the directory, and each
+    yield curve is built from its mapped forward rates on first access, without rerunning the
+    bootstrap. It keeps the mapped inputs, so its Jacobians are those of the curve saved.
+    Only the pages of the curves used are read from disk.
+    Access is thread-safe.
+*/
+class MarketFile
+{
+public:
+  /** Opens and validates the file */
+  explicit MarketFile(std::string const& path);
+
+  /** Unmaps the file */
+  ~MarketFile();
+
+  MarketFile(MarketFile const&) = delete;
+  MarketFile& operator=(MarketFile const&) = delete;
+
+  /** Returns the version of the market snapshot that was written */
+  unsigned long version() const { return version_; }
+
+  /** Returns the names of the yield curves, in file order */
+  std::vector<std::string> yieldCurveNames() const;
+
+  /** Returns the yield curve with this name, building it on first access; null if there is none */
+  SPtrYieldCurve yieldCurve(std::string const& name) const;
+
+  /** Builds all yield curves into ycmap, with their saved version numbers */
+  void load(SPtrMap<YieldCurve>& ycmap) const;
+
+private:
+  // A directory entry and its lazily built curve
+  struct Entry
+  {
+    std::string name;
+    YieldCurve::InputType intype;
+    size_t nPoints;
+    double const* times;
+    double const* rates;
+    double const* tMats;
+    double const* quotes;
+    unsigned long version;
+    mutable std::once_flag built;
+    mutable SPtrYieldCurve curve;
+  };
+
+  SPtrYieldCurve build(Entry const& e) const;
+  void unmap();
+
+  void const* data_;    // the mapped file
+  size_t size_;         // its size in bytes
+  void* handle_;        // the file mapping handle on Windows
+  unsigned long version_;
+  std::vector<std::unique_ptr<Entry>> entries_;
+  std::unordered_map<std::string, size_t> index_;   // the entry of each name
+};
+
+END_NAMESPACE(qf)
+
+#endif // QF_MARKETFILE_HPP
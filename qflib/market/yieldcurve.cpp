@@ -4,75 +4,36 @@
 */
 
 #include <qflib/market/yieldcurve.hpp>
+#include <qflib/threadpool.hpp>
+#include <algorithm>
 
 BEGIN_NAMESPACE(qf)
 
 using namespace std;
 
-void YieldCurve::initFromZeroBonds()
-{
-  auto cit = fwdrates_.coeff_begin(0);
-
-  double T1 = 0.0;                  // the observation time is t = 0;
-  double p1 = 1.0;                  // bond maturing at T1
-  for (size_t i = 0; i < fwdrates_.size(); ++i, ++cit) {
-    double T2 = fwdrates_.breakPoint(i);
-    double p2 = *cit;
-    QF_ASSERT(p2 <= 1.0 && p2 > 0, "YieldCurve: zero bond prices must in (0,1]");
-    double fwdrate = std::log(p1 / p2);
-    QF_ASSERT(fwdrate >= 0.0,
-      "YieldCurve: negative fwd rate between T1 = " + to_string(T1) + " and T2 = " + to_string(T2));
-    double dt = T2 - T1;          // calculate DeltaT for the next iteration
-    fwdrate /= dt;
-    fwdrates_.setBreakPoint(i, T1); // remember, the ppoly object is right-continuous 
-    *cit = fwdrate;                 // overwrite the zero bond with the fwd rate
-    p1 = p2;                        // remember the bond price
-    T1 = T2;                        // remember the maturity
-  }
-}
+namespace {
 
-void YieldCurve::initFromSpotRates()
-{
-  auto cit = fwdrates_.coeff_begin(0);
-
-  double T1 = fwdrates_.breakPoint(0);
-  double R1 = *cit;
-  fwdrates_.setBreakPoint(0, 0.0); // remember, the ppoly object is right-continuous
-  ++cit;
-  for (size_t i = 1; i < fwdrates_.size(); ++i, ++cit) {
-    double T2 = fwdrates_.breakPoint(i);
-    double R2 = *cit;
-    double F = R2 * T2 - R1 * T1;
-    QF_ASSERT(F >= 0.0,
-      "YieldCurve: negative fwd rate between T1 = " + to_string(T1) +" and T2 = " + to_string(T2));
-    F /= (T2 - T1);
-    fwdrates_.setBreakPoint(i, T1);
-    *cit = F;
-    T1 = T2;
-    R1 = R2;
-  }
-}
+// Number of times per task of the batch queries
+const size_t QUERY_BLOCK_SIZE = 1024;
 
-void YieldCurve::initFromFwdRates()
+// Calls f(i) for i in [0, n), in blocks of QUERY_BLOCK_SIZE distributed over threadPool()
+template<typename F>
+void parallelForBlocks(size_t n, F const& f)
 {
-  // just validate the fwd rates
-  auto cit = fwdrates_.coeff_begin(0);
-  double T1 = 0.0;
-  for (size_t i = 0; i < fwdrates_.size(); ++i, ++cit) {
-    double T2 = fwdrates_.breakPoints()(i);
-    fwdrates_.setBreakPoint(i, T1);  // remember, the ppoly object is right-continuous
-    double fwdrate = *cit;
-    QF_ASSERT(fwdrate >= 0.0,
-      "YieldCurve: negative fwd rate between T1 = " + to_string(T1) + " and T2 = " + to_string(T2));
-    T1 = T2;
-  }
+  size_t nBlocks = (n + QUERY_BLOCK_SIZE - 1) / QUERY_BLOCK_SIZE;
+  threadPool().parallelFor(nBlocks, [&](size_t ib) {
+    size_t iEnd = min(n, (ib + 1) * QUERY_BLOCK_SIZE);
+    for (size_t i = ib * QUERY_BLOCK_SIZE; i < iEnd; ++i)
+      f(i);
+  });
 }
 
+} // anonymous namespace
 
 double YieldCurve::discount(double tMat) const
 {
   QF_ASSERT(tMat >= 0.0, "YieldCurve: negative times not allowed");
-  double ldf = -fwdrates_.integral(0.0, tMat);
+  double ldf = -fwdRateIntegral(tMat);
   return exp(ldf);
 }
 
@@ -80,14 +41,14 @@ double YieldCurve::fwdDiscount(double tMat1, double tMat2) const
 {
   QF_ASSERT(tMat1 >= 0.0, "YieldCurve: discount factors for negative times not allowed");
   QF_ASSERT(tMat1 <= tMat2, "YieldCurve: maturities are out of order");
-  double ldf = -fwdrates_.integral(tMat1, tMat2);
+  double ldf = -fwdRateIntegral(tMat1, tMat2);
   return exp(ldf);
 }
 
 double YieldCurve::spotRate(double tMat) const
 {
   QF_ASSERT(tMat >= 0.0, "YieldCurve: spot rates for negative times not allowed");
-  double srate = fwdrates_.integral(0.0, tMat);
+  double srate = fwdRateIntegral(tMat);
   return srate / tMat;  // return the annualized rate
 }
 
@@ -95,8 +56,172 @@ double YieldCurve::fwdRate(double tMat1, double tMat2) const
 {
   QF_ASSERT(tMat1 >= 0.0, "YieldCurve: discount factors for negative times not allowed");
   QF_ASSERT(tMat1 <= tMat2, "YieldCurve: maturities are out of order");
-  double frate = fwdrates_.integral(tMat1, tMat2);
+  double frate = fwdRateIntegral(tMat1, tMat2);
   return frate / (tMat2 - tMat1);  // return the annualized rate
 }
 
+void YieldCurve::discount(size_t n, double const* tMat, double* df) const
+{
+  for (size_t i = 0; i < n; ++i)
+    QF_ASSERT(tMat[i] >= 0.0, "YieldCurve: negative times not allowed; element " + to_string(i));
+  parallelForBlocks(n, [&](size_t i) {
+    double ldf = -fwdRateIntegral(tMat[i]);
+    df[i] = exp(ldf);
+  });
+}
+
+void YieldCurve::fwdDiscount(size_t n, double const* tMat1, double const* tMat2, double* fdf) const
+{
+  for (size_t i = 0; i < n; ++i) {
+    QF_ASSERT(tMat1[i] >= 0.0, "YieldCurve: discount factors for negative times not allowed; element " + to_string(i));
+    QF_ASSERT(tMat1[i] <= tMat2[i], "YieldCurve: maturities are out of order; element " + to_string(i));
+  }
+  parallelForBlocks(n, [&](size_t i) {
+    double ldf = -fwdRateIntegral(tMat1[i], tMat2[i]);
+    fdf[i] = exp(ldf);
+  });
+}
+
+void YieldCurve::spotRate(size_t n, double const* tMat, double* rate) const
+{
+  for (size_t i = 0; i < n; ++i)
+    QF_ASSERT(tMat[i] >= 0.0, "YieldCurve: spot rates for negative times not allowed; element " + to_string(i));
+  parallelForBlocks(n, [&](size_t i) {
+    double srate = fwdRateIntegral(tMat[i]);
+    rate[i] = srate / tMat[i];
+  });
+}
+
+void YieldCurve::fwdRate(size_t n, double const* tMat1, double const* tMat2, double* rate) const
+{
+  for (size_t i = 0; i < n; ++i) {
+    QF_ASSERT(tMat1[i] >= 0.0, "YieldCurve: discount factors for negative times not allowed; element " + to_string(i));
+    QF_ASSERT(tMat1[i] <= tMat2[i], "YieldCurve: maturities are out of order; element " + to_string(i));
+  }
+  parallelForBlocks(n, [&](size_t i) {
+    double frate = fwdRateIntegral(tMat1[i], tMat2[i]);
+    rate[i] = frate / (tMat2[i] - tMat1[i]);
+  });
+}
+
+Matrix YieldCurve::Jacobian::toMatrix() const
+{
+  Matrix m(nRows(), nCols, arma::fill::zeros);
+  for (size_t i = 0; i < nRows(); ++i)
+    for (size_t k = rowStart[i]; k < rowStart[i + 1]; ++k)
+      m(i, columns[k]) = values[k];
+  return m;
+}
+
+void YieldCurve::fwdRateIntegralGradient(double t, Gradient& g) const
+{
+  // in period k the integral is linear in the quotes around it, see the FwdRateCurve ctor
+  g.clear();
+  std::vector<double> const& times = curve_.times();
+  size_t k = periodIndex(t);
+  switch (intype_) {
+  case InputType::FWDRATE:
+    for (size_t j = 0; j < k; ++j)
+      g.emplace_back(j, times[j + 1] - times[j]);
+    g.emplace_back(k, t - times[k]);
+    break;
+  case InputType::SPOTRATE: {
+    // I(t) = (1 - w) R[k-1] T[k-1] + w R[k] T[k]
+    double w = (t - times[k]) / (tMats_[k] - times[k]);
+    if (k > 0)
+      g.emplace_back(k - 1, times[k] * (1.0 - w));
+    g.emplace_back(k, tMats_[k] * w);
+    break;
+  }
+  case InputType::ZEROBOND: {
+    // I(t) = -(1 - w) log P[k-1] - w log P[k]
+    double w = (t - times[k]) / (tMats_[k] - times[k]);
+    if (k > 0)
+      g.emplace_back(k - 1, -(1.0 - w) / quotes_[k - 1]);
+    g.emplace_back(k, -w / quotes_[k]);
+    break;
+  }
+  default:
+    QF_ASSERT(0, "error: unknown yield curve input type");
+  }
+}
+
+void YieldCurve::appendRow(Jacobian& jac, double t1, double t2, double scale, Gradient& g1, Gradient& g2) const
+{
+  if (t1 > 0.0)
+    fwdRateIntegralGradient(t1, g1);
+  else
+    g1.clear();
+  fwdRateIntegralGradient(t2, g2);
+
+  // merge the two sorted gradients, keeping the nonzero differences
+  auto it1 = g1.begin(), it2 = g2.begin();
+  while (it1 != g1.end() || it2 != g2.end()) {
+    size_t col;
+    double d = 0.0;
+    if (it1 == g1.end() || (it2 != g2.end() && it2->first < it1->first)) {
+      col = it2->first;
+      d = (it2++)->second;
+    }
+    else if (it2 == g2.end() || it1->first < it2->first) {
+      col = it1->first;
+      d = -(it1++)->second;
+    }
+    else {
+      col = it1->first;
+      d = (it2++)->second - (it1++)->second;
+    }
+    if (d != 0.0) {
+      jac.columns.push_back(col);
+      jac.values.push_back(scale * d);
+    }
+  }
+  jac.rowStart.push_back(jac.columns.size());
+}
+
+YieldCurve::Jacobian YieldCurve::discountJacobian(size_t n, double const* tMat) const
+{
+  Jacobian jac;
+  jac.nCols = quotes_.size();
+  Gradient g1, g2;
+  for (size_t i = 0; i < n; ++i)
+    appendRow(jac, 0.0, tMat[i], -discount(tMat[i]), g1, g2);
+  return jac;
+}
+
+YieldCurve::Jacobian YieldCurve::fwdDiscountJacobian(size_t n, double const* tMat1, double const* tMat2) const
+{
+  Jacobian jac;
+  jac.nCols = quotes_.size();
+  Gradient g1, g2;
+  for (size_t i = 0; i < n; ++i)
+    appendRow(jac, tMat1[i], tMat2[i], -fwdDiscount(tMat1[i], tMat2[i]), g1, g2);
+  return jac;
+}
+
+YieldCurve::Jacobian YieldCurve::spotRateJacobian(size_t n, double const* tMat) const
+{
+  Jacobian jac;
+  jac.nCols = quotes_.size();
+  Gradient g1, g2;
+  for (size_t i = 0; i < n; ++i) {
+    QF_ASSERT(tMat[i] > 0.0, "YieldCurve: spot rate derivatives need positive times");
+    appendRow(jac, 0.0, tMat[i], 1.0 / tMat[i], g1, g2);
+  }
+  return jac;
+}
+
+YieldCurve::Jacobian YieldCurve::fwdRateJacobian(size_t n, double const* tMat1, double const* tMat2) const
+{
+  Jacobian jac;
+  jac.nCols = quotes_.size();
+  Gradient g1, g2;
+  for (size_t i = 0; i < n; ++i) {
+    QF_ASSERT(tMat1[i] >= 0.0, "YieldCurve: discount factors for negative times not allowed");
+    QF_ASSERT(tMat1[i] < tMat2[i], "YieldCurve: maturities are out of order");
+    appendRow(jac, tMat1[i], tMat2[i], 1.0 / (tMat2[i] - tMat1[i]), g1, g2);
+  }
+  return jac;
+}
+
 END_NAMESPACE(qf)
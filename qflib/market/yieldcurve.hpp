@@ -8,9 +8,13 @@
 
 #include <qflib/defines.hpp>
 #include <qflib/exception.hpp>
-#include <qflib/math/interpol/piecewisepolynomial.hpp>
+#include <qflib/math/matrix.hpp>
+#include <qflib/market/fwdratecurve.hpp>
 #include <qflib/sptr.hpp>
+#include <algorithm>
 #include <string>
+#include <utility>
+#include <vector>
 
 BEGIN_NAMESPACE(qf)
 
@@ -20,12 +24,7 @@ class YieldCurve
 public:
 
   /** Used to qualify the type of quantities used for building the curve */
-  enum class InputType
-  {
-    SPOTRATE,
-    FWDRATE,
-    ZEROBOND
-  };
+  using InputType = YieldCurveInputType;
 
   /** The swap frequency */
   enum class SwapFreq
@@ -44,6 +43,24 @@ public:
     SIMPLE
   };
 
+  /** Sparse Jacobian of curve quantities with respect to the input quotes, in compressed row
+      format: row i has the nonzero derivatives values[rowStart[i], rowStart[i + 1]) with respect
+      to the quotes with indices columns[rowStart[i], rowStart[i + 1]), in increasing order
+  */
+  struct Jacobian
+  {
+    size_t nCols = 0;
+    std::vector<size_t> rowStart{ 0 };
+    std::vector<size_t> columns;
+    std::vector<double> values;
+
+    /** Returns the number of rows */
+    size_t nRows() const { return rowStart.size() - 1; }
+
+    /** Returns the dense nRows() x nCols matrix */
+    Matrix toMatrix() const;
+  };
+
   /** Ctor from times to Maturity and corresponding continuous compounded rates */
   template<typename XITER, typename YITER>
   YieldCurve(XITER tMatBegin,
@@ -52,6 +69,18 @@ public:
              YITER rateEnd,
              InputType rtype = InputType::SPOTRATE);
 
+  /** Ctor from the input quotes and the forward rates bootstrapped from them, as returned by
+      fwdRateTimes() and fwdRates(), without rerunning the bootstrap; used to load saved curves
+  */
+  template<typename XITER, typename YITER>
+  YieldCurve(XITER tMatBegin,
+             XITER tMatEnd,
+             YITER rateBegin,
+             YITER rateEnd,
+             InputType intype,
+             std::vector<double> fwdRateTimes,
+             std::vector<double> fwdRates);
+
   /** Returns the curve currency */
   std::string ccy() const { return ccy_; }
 
@@ -67,6 +96,60 @@ public:
   /** Returns the forward rate between times tMat1 and tMat2 */
   double fwdRate(double tMat1, double tMat2) const;
 
+  // Batch queries. All times are validated once, before any result is computed;
+  // the results are the same as those of the scalar functions.
+  // Large batches are computed in blocks, in parallel on threadPool().
+
+  /** Writes to df[i] the discount factor to tMat[i], for i in [0, n) */
+  void discount(size_t n, double const* tMat, double* df) const;
+
+  /** Writes to fdf[i] the forward discount factor from tMat1[i] to tMat2[i], for i in [0, n) */
+  void fwdDiscount(size_t n, double const* tMat1, double const* tMat2, double* fdf) const;
+
+  /** Writes to rate[i] the spot rate at tMat[i], for i in [0, n) */
+  void spotRate(size_t n, double const* tMat, double* rate) const;
+
+  /** Writes to rate[i] the forward rate between tMat1[i] and tMat2[i], for i in [0, n) */
+  void fwdRate(size_t n, double const* tMat1, double const* tMat2, double* rate) const;
+
+  /** Returns the start times of the forward rate periods; the first is 0 */
+  std::vector<double> const& fwdRateTimes() const { return curve_.times(); }
+
+  /** Returns the forward rates of the periods starting at fwdRateTimes() */
+  std::vector<double> const& fwdRates() const { return curve_.rates(); }
+
+  /** Returns the type of the input quotes */
+  InputType inputType() const { return intype_; }
+
+  /** Returns the maturities of the input quotes */
+  std::vector<double> const& maturities() const { return tMats_; }
+
+  /** Returns the input quotes */
+  std::vector<double> const& quotes() const { return quotes_; }
+
+  // Sensitivities to the input quotes.
+  // The forward rates are piecewise constant, so the derivatives are exact and in closed form:
+  // for spot rates and zero bonds each row depends on the two quotes around each of its times,
+  // for forward rates on the quotes up to them. The rows are computed in O(1) each.
+
+  /** Returns the derivatives of discount(tMat[i]) for i in [0, n) by the input quotes */
+  Jacobian discountJacobian(size_t n, double const* tMat) const;
+
+  /** Returns the derivatives of fwdDiscount(tMat1[i], tMat2[i]) for i in [0, n) by the input quotes */
+  Jacobian fwdDiscountJacobian(size_t n, double const* tMat1, double const* tMat2) const;
+
+  /** Returns the derivatives of spotRate(tMat[i]) for i in [0, n) by the input quotes */
+  Jacobian spotRateJacobian(size_t n, double const* tMat) const;
+
+  /** Returns the derivatives of fwdRate(tMat1[i], tMat2[i]) for i in [0, n) by the input quotes */
+  Jacobian fwdRateJacobian(size_t n, double const* tMat1, double const* tMat2) const;
+
+  /** Returns the derivatives of discount(tMat) by the input quotes, as a one-row Jacobian */
+  Jacobian discountJacobian(double tMat) const { return discountJacobian(1, &tMat); }
+
+  /** Returns the derivatives of fwdRate(tMat1, tMat2) by the input quotes, as a one-row Jacobian */
+  Jacobian fwdRateJacobian(double tMat1, double tMat2) const { return fwdRateJacobian(1, &tMat1, &tMat2); }
+
   /** Returns the swap rate at time tMat */
   // TODO Not implemented yet, requires frequency arg
   // double swapRate(double tMat1) const;
@@ -79,13 +162,24 @@ public:
 protected:
 
 private:
-  // helper functions
-  void initFromZeroBonds();
-  void initFromSpotRates();
-  void initFromFwdRates();
+  // Returns the index of the forward rate period containing t >= 0
+  size_t periodIndex(double t) const { return curve_.periodIndex(t); }
+  // Returns the integral of the forward rates from 0 to t, in O(log n)
+  double fwdRateIntegral(double t) const { return curve_.integral(t); }
+  // Returns the integral of the forward rates from t1 to t2
+  double fwdRateIntegral(double t1, double t2) const { return curve_.integral(t1, t2); }
+  // Sparse gradient, sorted by quote index
+  using Gradient = std::vector<std::pair<size_t, double>>;
+  // Writes the derivatives of fwdRateIntegral(t) by the quotes to g
+  void fwdRateIntegralGradient(double t, Gradient& g) const;
+  // Appends to jac the row scale * d(fwdRateIntegral(t1, t2)), using g1 and g2 as scratch space
+  void appendRow(Jacobian& jac, double t1, double t2, double scale, Gradient& g1, Gradient& g2) const;
 
   std::string ccy_;  // the curve's currency
-  PiecewisePolynomial fwdrates_;  // the piecewise constant forward rates
+  InputType intype_;             // the type of the input quotes
+  std::vector<double> tMats_;    // the maturities of the input quotes
+  std::vector<double> quotes_;   // the input quotes
+  FwdRateCurve<double> curve_;   // the forward rates bootstrapped from the quotes
 };
 
 using SPtrYieldCurve = std::shared_ptr<YieldCurve>;
@@ -99,26 +193,27 @@ YieldCurve::YieldCurve(XITER tMatBegin,
                        YITER rateBegin,
                        YITER rateEnd,
                        InputType intype)
-: ccy_("USD"), fwdrates_(tMatBegin, tMatEnd, rateBegin, 0)
+: ccy_("USD"), intype_(intype), tMats_(tMatBegin, tMatEnd), quotes_(rateBegin, rateEnd),
+  curve_(tMats_, quotes_.begin(), quotes_.end(), intype)
+{
+}
+
+template<typename XITER, typename YITER>
+YieldCurve::YieldCurve(XITER tMatBegin,
+                       XITER tMatEnd,
+                       YITER rateBegin,
+                       YITER rateEnd,
+                       InputType intype,
+                       std::vector<double> fwdRateTimes,
+                       std::vector<double> fwdRates)
+: ccy_("USD"), intype_(intype), tMats_(tMatBegin, tMatEnd), quotes_(rateBegin, rateEnd),
+  curve_(std::move(fwdRateTimes), std::move(fwdRates))
 {
-  std::ptrdiff_t n = tMatEnd - tMatBegin;
-  QF_ASSERT(n == rateEnd - rateBegin, "YieldCurve: different number of maturities and rates");
-  auto it = std::find_if_not(tMatBegin, tMatEnd, [](double x) {return x > 0.0;});
-  QF_ASSERT(it == tMatEnd, "YieldCurve: maturities must be positive");
-
-  switch (intype) {
-  case YieldCurve::InputType::ZEROBOND:
-    initFromZeroBonds();
-    break;
-  case YieldCurve::InputType::SPOTRATE:
-    initFromSpotRates();
-    break;
-  case YieldCurve::InputType::FWDRATE:
-    initFromFwdRates();
-    break;
-  default:
-    QF_ASSERT(0, "error: unknown yield curve input type");
-  }
+  // forward rate i starts at maturity i - 1, which the Jacobians rely on
+  std::vector<double> const& times = curve_.times();
+  QF_ASSERT(quotes_.size() == tMats_.size() && times.size() == tMats_.size()
+            && std::equal(times.begin() + 1, times.end(), tMats_.begin()),
+            "YieldCurve: forward rate times do not match the maturities");
 }
 
 END_NAMESPACE(qf)
@@ -0,0 +1,101 @@
+/**
+@file  yieldcurvet.hpp
+@brief Yield curve templated on the number type, for algorithmic differentiation
+*/
+
+#ifndef QF_YIELDCURVET_HPP
+#define QF_YIELDCURVET_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <qflib/market/yieldcurve.hpp>
+#include <qflib/market/fwdratecurve.hpp>
+#include <cmath>
+#include <vector>
+
+BEGIN_NAMESPACE(qf)
+
+/** The yield curve of YieldCurve, with the input rates and all results of number type T.
+    With T = AReal the curve records its bootstrap on the tape, so one backward sweep through a
+    pricing gives the sensitivities to every input rate. The maturities stay double.
+    The bootstrap and the integrals are those of YieldCurve, in FwdRateCurve<T>, so with
+    T = double it gives the same results as YieldCurve, bit for bit.
+*/
+template<typename T>
+class YieldCurveT
+{
+public:
+  /** Ctor from times to maturity and the corresponding inputs, as for YieldCurve */
+  template<typename XITER, typename YITER>
+  YieldCurveT(XITER tMatBegin,
+              XITER tMatEnd,
+              YITER rateBegin,
+              YITER rateEnd,
+              YieldCurve::InputType intype = YieldCurve::InputType::SPOTRATE)
+  : curve_(std::vector<double>(tMatBegin, tMatEnd), rateBegin, rateEnd, intype)
+  {}
+
+  /** Returns the discount factor from observation date to tMat */
+  T discount(double tMat) const;
+
+  /** Returns the forward discount factor from observation date to tMat */
+  T fwdDiscount(double tMat1, double tMat2) const;
+
+  /** Returns the spot rate at time tMat */
+  T spotRate(double tMat) const;
+
+  /** Returns the forward rate between times tMat1 and tMat2 */
+  T fwdRate(double tMat1, double tMat2) const;
+
+  /** Returns the start times of the forward rate periods; the first is 0 */
+  std::vector<double> const& fwdRateTimes() const { return curve_.times(); }
+
+  /** Returns the forward rates of the periods starting at fwdRateTimes() */
+  std::vector<T> const& fwdRates() const { return curve_.rates(); }
+
+private:
+  FwdRateCurve<T> curve_;   // the same bootstrap and integrals as YieldCurve
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline implementations
+
+template<typename T>
+T YieldCurveT<T>::discount(double tMat) const
+{
+  using std::exp;
+  QF_ASSERT(tMat >= 0.0, "YieldCurve: negative times not allowed");
+  T ldf = -curve_.integral(tMat);
+  return exp(ldf);
+}
+
+template<typename T>
+T YieldCurveT<T>::fwdDiscount(double tMat1, double tMat2) const
+{
+  using std::exp;
+  QF_ASSERT(tMat1 >= 0.0, "YieldCurve: discount factors for negative times not allowed");
+  QF_ASSERT(tMat1 <= tMat2, "YieldCurve: maturities are out of order");
+  T ldf = -curve_.integral(tMat1, tMat2);
+  return exp(ldf);
+}
+
+template<typename T>
+T YieldCurveT<T>::spotRate(double tMat) const
+{
+  QF_ASSERT(tMat >= 0.0, "YieldCurve: spot rates for negative times not allowed");
+  T srate = curve_.integral(tMat);
+  return srate / tMat;  // return the annualized rate
+}
+
+template<typename T>
+T YieldCurveT<T>::fwdRate(double tMat1, double tMat2) const
+{
+  QF_ASSERT(tMat1 >= 0.0, "YieldCurve: discount factors for negative times not allowed");
+  QF_ASSERT(tMat1 <= tMat2, "YieldCurve: maturities are out of order");
+  T frate = curve_.integral(tMat1, tMat2);
+  return frate / (tMat2 - tMat1);  // return the annualized rate
+}
+
+END_NAMESPACE(qf)
+
+#endif // QF_YIELDCURVET_HPP
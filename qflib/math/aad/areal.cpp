@@ -0,0 +1,86 @@
+/**
+@file  areal.cpp
+@brief Implementation of the algorithmic differentiation tape
+*/
+
+#include <qflib/math/aad/areal.hpp>
+
+#include <algorithm>
+
+BEGIN_NAMESPACE(qf)
+
+Tape& Tape::active()
+{
+  static thread_local Tape tape;
+  return tape;
+}
+
+void Tape::rewind(Mark const& mark)
+{
+  QF_ASSERT(mark.nNodes <= nodes_.size() && mark.nArgs <= args_.size(), "Tape: mark is past the end of the tape");
+  nodes_.truncate(mark.nNodes);
+  args_.truncate(mark.nArgs);
+  adjoints_.clear();
+}
+
+void Tape::propagate(AReal const& y, double seed)
+{
+  adjoints_.assign(nodes_.size(), 0.0);
+  if (!y.active())
+    return;
+  adjoints_[y.node()] = seed;
+  for (size_t i = y.node() + 1; i-- > 0; ) {
+    double a = adjoints_[i];
+    if (a == 0.0)
+      continue;
+    Node const& node = nodes_[i];
+    for (size_t k = node.firstArg; k < node.firstArg + node.nArgs; ++k) {
+      Arg const& arg = args_[k];
+      adjoints_[arg.node] += a * arg.partial;
+    }
+  }
+}
+
+AReal Tape::checkpoint(Mark const& mark, AReal const& y)
+{
+  if (!y.active() || y.node() < mark.nNodes) {
+    rewind(mark);
+    return y;
+  }
+
+  // sweep the nodes after mark, collecting the adjoints of the earlier nodes they depend on
+  std::vector<double>& local = scratch_;
+  std::vector<Arg>& outer = outer_;
+  local.assign(y.node() + 1 - mark.nNodes, 0.0);
+  outer.clear();
+  local[y.node() - mark.nNodes] = 1.0;
+  for (size_t i = y.node() + 1; i-- > mark.nNodes; ) {
+    double a = local[i - mark.nNodes];
+    if (a == 0.0)
+      continue;
+    Node const& node = nodes_[i];
+    for (size_t k = node.firstArg; k < node.firstArg + node.nArgs; ++k) {
+      Arg const& arg = args_[k];
+      if (arg.node >= mark.nNodes)
+        local[arg.node - mark.nNodes] += a * arg.partial;
+      else
+        outer.push_back(Arg{ arg.node, a * arg.partial });
+    }
+  }
+
+  // merge the derivatives by node, then replace the nodes after mark
+  std::sort(outer.begin(), outer.end(), [](Arg const& a, Arg const& b) { return a.node < b.node; });
+  double v = y.value();
+  rewind(mark);
+  size_t first = args_.size();
+  for (Arg const& arg : outer) {
+    if (args_.size() > first && args_[args_.size() - 1].node == arg.node)
+      args_[args_.size() - 1].partial += arg.partial;
+    else
+      args_.push_back(arg);
+  }
+  nodes_.push_back(Node{ first, args_.size() - first });
+  return AReal(v, nodes_.size() - 1);
+}
+
+END_NAMESPACE(qf)
@@ -0,0 +1,255 @@
+/**
+@file  areal.hpp
+@brief Reverse-mode algorithmic differentiation: the tape and the active real number type
+*/
+
+#ifndef QF_AREAL_HPP
+#define QF_AREAL_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <qflib/math/stats/errorfunction.hpp>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+BEGIN_NAMESPACE(qf)
+
+class AReal;
+
+/** The tape of a reverse-mode algorithmic differentiation (AAD) computation.
+    Every operation on active AReal numbers records a node with the partial derivatives of its
+    result with respect to its arguments; propagate() then sweeps the nodes backwards once,
+    computing the adjoints, i.e. the derivatives of one result with respect to every input.
+    Nodes are stored in fixed-size blocks that are reused by clear() and rewind(), so recording
+    does not allocate once the tape has grown to the size of the computation.
+    checkpoint() replaces the nodes of a finished sub-computation, e.g. the pricing of one trade,
+    by a single node holding its gradient, which bounds the tape of a portfolio by its inputs.
+    Each thread records on its own tape, returned by Tape::active(), which is the only way to
+    get one: AReal operations always record on the tape of the calling thread.
+*/
+class Tape
+{
+public:
+  /** The index of a node; PASSIVE for numbers that are not recorded */
+  using Index = size_t;
+  static constexpr Index PASSIVE = Index(-1);
+
+  /** A position on the tape */
+  struct Mark
+  {
+    size_t nNodes;
+    size_t nArgs;
+  };
+
+  /** Returns the tape of the calling thread */
+  static Tape& active();
+
+  /** Returns a new input with value v, recorded on this tape */
+  AReal newInput(double v);
+
+  /** Returns the number of recorded nodes */
+  size_t size() const { return nodes_.size(); }
+
+  /** Returns the current position, for rewind() and checkpoint() */
+  Mark mark() const { return Mark{ nodes_.size(), args_.size() }; }
+
+  /** Drops the nodes recorded after mark; numbers recorded after it must not be used again */
+  void rewind(Mark const& mark);
+
+  /** Drops all nodes, keeping the memory for the next computation */
+  void clear() { rewind(Mark{ 0, 0 }); }
+
+  /** Computes the adjoints of all nodes up to y, with the adjoint of y set to seed */
+  void propagate(AReal const& y, double seed = 1.0);
+
+  /** Returns the adjoint of x after propagate(), i.e. the derivative of the result by x */
+  double adjoint(AReal const& x) const;
+
+  /** Replaces the nodes recorded after mark, which computed y, by one node with the derivatives
+      of y with respect to the numbers recorded before mark; returns y recorded on that node
+  */
+  AReal checkpoint(Mark const& mark, AReal const& y);
+
+  /** Records a node with n arguments and their partial derivatives; passive arguments are skipped */
+  Index record(size_t n, Index const* args, double const* partials);
+
+private:
+  /** only active() creates tapes; copies are forbidden */
+  Tape() = default;
+  Tape(Tape const&) = delete;
+  Tape& operator=(Tape const&) = delete;
+
+  // Storage in blocks that are never moved
+  template<typename T>
+  class BlockArena
+  {
+  public:
+    size_t size() const { return size_; }
+    T& operator[](size_t i) { return blocks_[i >> BLOCK_BITS][i & BLOCK_MASK]; }
+    T const& operator[](size_t i) const { return blocks_[i >> BLOCK_BITS][i & BLOCK_MASK]; }
+    void push_back(T const& v)
+    {
+      if (size_ == (blocks_.size() << BLOCK_BITS))
+        blocks_.emplace_back(new T[size_t(1) << BLOCK_BITS]);
+      (*this)[size_++] = v;
+    }
+    void truncate(size_t n) { size_ = n; }
+
+  private:
+    static const size_t BLOCK_BITS = 14;
+    static const size_t BLOCK_MASK = (size_t(1) << BLOCK_BITS) - 1;
+    std::vector<std::unique_ptr<T[]>> blocks_;
+    size_t size_ = 0;
+  };
+
+  struct Node
+  {
+    size_t firstArg;
+    size_t nArgs;
+  };
+
+  struct Arg
+  {
+    Index node;
+    double partial;
+  };
+
+  BlockArena<Node> nodes_;
+  BlockArena<Arg> args_;
+  std::vector<double> adjoints_;
+
+  // scratch space of checkpoint()
+  std::vector<double> scratch_;
+  std::vector<Arg> outer_;
+};
+
+/** A real number for reverse-mode algorithmic differentiation.
+    Numbers made by Tape::newInput() and all results computed from them are active: their
+    operations are recorded on the tape of the calling thread. Numbers converted from double are
+    passive constants and record nothing.
+    The arithmetic operators, comparisons and the math functions are found by argument-dependent
+    lookup, so code templated on the number type calls exp(x), log(x), normalCdf(x), ...
+    unqualified, and works unchanged with double.
+*/
+class AReal
+{
+public:
+  /** Passive zero */
+  AReal() : value_(0.0), node_(Tape::PASSIVE) {}
+
+  /** Passive constant */
+  AReal(double v) : value_(v), node_(Tape::PASSIVE) {}
+
+  /** Returns the value */
+  double value() const { return value_; }
+
+  /** Returns true if the number is recorded on the tape */
+  bool active() const { return node_ != Tape::PASSIVE; }
+
+  /** Returns the node index on the tape */
+  Tape::Index node() const { return node_; }
+
+  AReal& operator+=(AReal const& b) { return *this = *this + b; }
+  AReal& operator-=(AReal const& b) { return *this = *this - b; }
+  AReal& operator*=(AReal const& b) { return *this = *this * b; }
+  AReal& operator/=(AReal const& b) { return *this = *this / b; }
+
+  friend AReal operator+(AReal const& a) { return a; }
+  friend AReal operator-(AReal const& a) { return unary(-a.value_, a, -1.0); }
+
+  friend AReal operator+(AReal const& a, AReal const& b) { return binary(a.value_ + b.value_, a, 1.0, b, 1.0); }
+  friend AReal operator-(AReal const& a, AReal const& b) { return binary(a.value_ - b.value_, a, 1.0, b, -1.0); }
+  friend AReal operator*(AReal const& a, AReal const& b) { return binary(a.value_ * b.value_, a, b.value_, b, a.value_); }
+  friend AReal operator/(AReal const& a, AReal const& b)
+  {
+    double q = a.value_ / b.value_;
+    return binary(q, a, 1.0 / b.value_, b, -q / b.value_);
+  }
+
+  friend bool operator==(AReal const& a, AReal const& b) { return a.value_ == b.value_; }
+  friend bool operator!=(AReal const& a, AReal const& b) { return a.value_ != b.value_; }
+  friend bool operator<(AReal const& a, AReal const& b) { return a.value_ < b.value_; }
+  friend bool operator<=(AReal const& a, AReal const& b) { return a.value_ <= b.value_; }
+  friend bool operator>(AReal const& a, AReal const& b) { return a.value_ > b.value_; }
+  friend bool operator>=(AReal const& a, AReal const& b) { return a.value_ >= b.value_; }
+
+  friend AReal exp(AReal const& a)
+  {
+    double e = std::exp(a.value_);
+    return unary(e, a, e);
+  }
+  friend AReal log(AReal const& a) { return unary(std::log(a.value_), a, 1.0 / a.value_); }
+  friend AReal sqrt(AReal const& a)
+  {
+    double s = std::sqrt(a.value_);
+    return unary(s, a, 0.5 / s);
+  }
+  friend AReal pow(AReal const& a, AReal const& b)
+  {
+    double p = std::pow(a.value_, b.value_);
+    double db = b.active() ? p * std::log(a.value_) : 0.0;
+    return binary(p, a, b.value_ * std::pow(a.value_, b.value_ - 1.0), b, db);
+  }
+  friend AReal fabs(AReal const& a) { return a.value_ < 0.0 ? -a : a; }
+  friend AReal abs(AReal const& a) { return fabs(a); }
+
+  /** The standard normal cumulative distribution function */
+  friend AReal normalCdf(AReal const& a)
+  {
+    return unary(0.5 * ErrorFunction::erfc(-M_SQRT1_2 * a.value_), a, M_1_SQRT2PI * std::exp(-0.5 * a.value_ * a.value_));
+  }
+
+private:
+  friend class Tape;
+
+  AReal(double v, Tape::Index node) : value_(v), node_(node) {}
+
+  static AReal unary(double v, AReal const& a, double da)
+  {
+    if (!a.active())
+      return AReal(v);
+    return AReal(v, Tape::active().record(1, &a.node_, &da));
+  }
+
+  static AReal binary(double v, AReal const& a, double da, AReal const& b, double db)
+  {
+    if (!b.active())
+      return unary(v, a, da);
+    if (!a.active())
+      return unary(v, b, db);
+    Tape::Index args[2] = { a.node_, b.node_ };
+    double partials[2] = { da, db };
+    return AReal(v, Tape::active().record(2, args, partials));
+  }
+
+  double value_;
+  Tape::Index node_;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Inline definitions
+
+inline AReal Tape::newInput(double v)
+{
+  return AReal(v, record(0, nullptr, nullptr));
+}
+
+inline Tape::Index Tape::record(size_t n, Index const* args, double const* partials)
+{
+  size_t first = args_.size();
+  for (size_t i = 0; i < n; ++i)
+    if (args[i] != PASSIVE)
+      args_.push_back(Arg{ args[i], partials[i] });
+  nodes_.push_back(Node{ first, args_.size() - first });
+  return nodes_.size() - 1;
+}
+
+inline double Tape::adjoint(AReal const& x) const
+{
+  return x.active() && x.node() < adjoints_.size() ? adjoints_[x.node()] : 0.0;
+}
+
+END_NAMESPACE(qf)
+
+#endif // QF_AREAL_HPP
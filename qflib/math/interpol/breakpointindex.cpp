@@ -0,0 +1,117 @@
+/**
+@file  breakpointindex.cpp
+@brief Implementation of the search accelerator for sorted breakpoints
+*/
+
+#include <qflib/math/interpol/breakpointindex.hpp>
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+
+BEGIN_NAMESPACE(qf)
+
+namespace {
+
+// Smallest breakpoint set for which the bucket table is considered; below it the Eytzinger search is faster
+const size_t BUCKETS_MIN_SIZE = 256;
+// Number of buckets per breakpoint
+const size_t BUCKETS_PER_POINT = 2;
+// Maximum number of breakpoints per bucket for the bucket table to be used
+const size_t BUCKET_MAX_POINTS = 4;
+
+// Fills the 1-based Eytzinger array e from the sorted x, in-order traversal of the implicit tree
+size_t fillEytzinger(double const* x, size_t n, std::vector<double>& e, std::vector<ptrdiff_t>& rank,
+                     size_t i, size_t k)
+{
+  if (k <= n) {
+    i = fillEytzinger(x, n, e, rank, i, 2 * k);
+    e[k] = x[i];
+    rank[k] = i;
+    ++i;
+    i = fillEytzinger(x, n, e, rank, i, 2 * k + 1);
+  }
+  return i;
+}
+
+} // anonymous namespace
+
+void BreakpointIndex::build(double const* x, size_t n)
+{
+  clear();
+  if (n < MIN_SIZE || !(x[n - 1] > x[0]))
+    return;
+
+  // uniform buckets, if no bucket holds too many breakpoints
+  if (n >= BUCKETS_MIN_SIZE) {
+    size_t nb = BUCKETS_PER_POINT * n;
+    x0_ = x[0];
+    invWidth_ = nb / (x[n - 1] - x[0]);
+    std::vector<size_t> count(nb, 0);
+    for (size_t i = 0; i < n; ++i)
+      ++count[std::min(nb - 1, static_cast<size_t>((x[i] - x0_) * invWidth_))];
+    if (*std::max_element(count.begin(), count.end()) <= BUCKET_MAX_POINTS) {
+      bucket_.resize(nb);
+      for (size_t b = 0, i = 0; b < nb; ++b) {
+        double start = x0_ + b / invWidth_;
+        while (i + 1 < n && x[i + 1] <= start)
+          ++i;
+        bucket_[b] = i;
+      }
+      method_ = Method::BUCKETS;
+      return;
+    }
+  }
+
+  // Eytzinger layout
+  eytz_.assign(n + 1, 0.0);
+  rank_.assign(n + 1, 0);
+  fillEytzinger(x, n, eytz_, rank_, 0, 1);
+  method_ = Method::EYTZINGER;
+}
+
+void BreakpointIndex::clear()
+{
+  method_ = Method::BINARY;
+  bucket_.clear();
+  eytz_.clear();
+  rank_.clear();
+}
+
+ptrdiff_t BreakpointIndex::findEytzinger(double t) const
+{
+  // descend the implicit tree to the first breakpoint greater than t
+  size_t n = eytz_.size() - 1;
+  std::uint64_t k = 1;
+  while (k <= n)
+    k = 2 * k + (eytz_[k] <= t);
+  // climb back over the right turns, then one left turn
+  k >>= std::countr_one(k) + 1;
+  return k == 0 ? ptrdiff_t(n) - 1 : rank_[k] - 1;
+}
+
+ptrdiff_t BreakpointIndex::find(double const* x, size_t n, double t) const
+{
+  switch (method_) {
+  case Method::BUCKETS:
+  {
+    if (t < x[0])
+      return -1;
+    if (x[n - 1] <= t)
+      return n - 1;
+    size_t b = std::min(bucket_.size() - 1, static_cast<size_t>((t - x0_) * invWidth_));
+    size_t i = bucket_[b];
+    while (x[i + 1] <= t)
+      ++i;
+    while (i > 0 && t < x[i])   // guards against rounding of the bucket
+      --i;
+    return i;
+  }
+  case Method::EYTZINGER:
+    return findEytzinger(t);
+  default:
+    return std::upper_bound(x, x + n, t) - x - 1;
+  }
+}
+
+END_NAMESPACE(qf)
@@ -0,0 +1,67 @@
+/**
+@file  breakpointindex.hpp
+@brief Search accelerator for sorted breakpoints
+*/
+
+#ifndef QF_BREAKPOINTINDEX_HPP
+#define QF_BREAKPOINTINDEX_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <vector>
+
+BEGIN_NAMESPACE(qf)
+
+/** Finds the interval of a point among strictly increasing breakpoints x[0, n), i.e.
+    the greatest i such that x[i] <= t, or -1 if t < x[0].
+    The index is built once for a set of breakpoints, and the method is chosen by their number
+    and spacing: binary search for fewer than MIN_SIZE breakpoints, a table of uniform buckets
+    for near-uniform breakpoints, and otherwise a branchless search on a copy of the breakpoints
+    in Eytzinger (breadth-first) order, which keeps the first levels of the search in cache.
+    The index does not own the breakpoints: find() must be called with the ones it was built for.
+*/
+class BreakpointIndex
+{
+public:
+  /** Breakpoint sets smaller than this are searched by binary search */
+  static const size_t MIN_SIZE = 32;
+
+  /** The search method */
+  enum class Method
+  {
+    BINARY,     // std::upper_bound on the breakpoints
+    BUCKETS,    // uniform bucket table, then a short linear scan
+    EYTZINGER   // branchless search in breadth-first order
+  };
+
+  /** Default ctor; the index uses binary search until built */
+  BreakpointIndex() : method_(Method::BINARY) {}
+
+  /** Builds the index for the strictly increasing breakpoints x[0, n) */
+  void build(double const* x, size_t n);
+
+  /** Discards the index, reverting to binary search, e.g. after the breakpoints change */
+  void clear();
+
+  /** Returns the search method in use */
+  Method method() const { return method_; }
+
+  /** Returns the greatest i such that x[i] <= t, or -1 if t < x[0] */
+  ptrdiff_t find(double const* x, size_t n, double t) const;
+
+private:
+  ptrdiff_t findEytzinger(double t) const;
+
+  Method method_;
+  // uniform buckets
+  double x0_ = 0.0;                // first breakpoint
+  double invWidth_ = 0.0;          // inverse of the bucket width
+  std::vector<size_t> bucket_;     // greatest i such that x[i] <= start of each bucket
+  // Eytzinger layout, 1-based
+  std::vector<double> eytz_;       // breakpoints in breadth-first order
+  std::vector<ptrdiff_t> rank_;    // index of each of them among the breakpoints
+};
+
+END_NAMESPACE(qf)
+
+#endif // QF_BREAKPOINTINDEX_HPP
@@ -4,11 +4,20 @@
 */
 
 #include <qflib/math/interpol/piecewisepolynomial.hpp>
+#include <qflib/math/simd.hpp>
 
 #include <cmath>
+#include <cstdint>
 
 BEGIN_NAMESPACE(qf)
 
+namespace {
+
+// Number of points located per block of the batch evaluation
+const size_t PP_BLOCK_POINTS = 256;
+
+} // anonymous namespace
+
 double PiecewisePolynomial::operator()(double x) const
 {
   size_t n(size());
@@ -42,6 +51,96 @@ double PiecewisePolynomial::eval(double x, size_t k) const
   return val;
 }
 
+void PiecewisePolynomial::eval(size_t nx, double const* x, double* y, size_t k) const
+{
+  if (nx == 0)
+    return;
+  size_t n(size());
+  size_t ord(order());
+  if (k > ord) {
+    std::fill(y, y + nx, 0.0);
+    return;
+  }
+
+  // coefficients of the k-th derivative, d_i = c_{i+k} (i+k)!/i!, one row of m per interval;
+  // rows n and n + 1 hold the flat extrapolation to the left and to the right
+  size_t m = ord - k + 1;
+  std::vector<double> d((n + 2) * m, 0.0);
+  for (size_t i = 0; i < m; ++i) {
+    double scale = 1.0;
+    for (size_t j = i + 1; j <= i + k; ++j)
+      scale *= j;
+    for (size_t s = 0; s < n; ++s)
+      d[s * m + i] = c_(i + k, s) * scale;
+  }
+  if (k == 0) {
+    d[n * m] = c_(0, 0);
+    d[(n + 1) * m] = c_(0, n - 1);
+  }
+
+  bool sorted = std::is_sorted(x, x + nx);
+  size_t idx = 0;
+  std::int64_t row[PP_BLOCK_POINTS];   // first coefficient of the interval of each point
+  double h[PP_BLOCK_POINTS];           // offset from the left breakpoint of the interval
+  for (size_t first = 0; first < nx; first += PP_BLOCK_POINTS) {
+    size_t nb = std::min(PP_BLOCK_POINTS, nx - first);
+    double const* xb = x + first;
+    double* yb = y + first;
+
+    // locate the points
+    for (size_t j = 0; j < nb; ++j) {
+      double xj = xb[j];
+      if (xj < x_(0)) {
+        row[j] = n * m;
+        h[j] = 0.0;
+      }
+      else if (x_(n - 1) <= xj) {
+        row[j] = (n + 1) * m;
+        h[j] = 0.0;
+      }
+      else {
+        if (sorted) {
+          while (x_(idx + 1) <= xj)
+            ++idx;
+        }
+        else
+          idx = index(xj);
+        row[j] = idx * m;
+        h[j] = xj - x_(idx);
+      }
+    }
+
+    // Horner's rule
+    size_t j = 0;
+#if QF_SIMD_WIDTH > 1
+    for (; j + QF_SIMD_WIDTH <= nb; j += QF_SIMD_WIDTH) {
+      simd::Vd hv = simd::load(h + j);
+      simd::Vd val;
+      if (sorted && row[j] == row[j + QF_SIMD_WIDTH - 1]) {
+        // all points in one interval
+        double const* dr = &d[row[j]];
+        val = simd::set1(dr[m - 1]);
+        for (size_t i = m - 1; i > 0; --i)
+          val = simd::fmadd(val, hv, simd::set1(dr[i - 1]));
+      }
+      else {
+        val = simd::gather(&d[m - 1], row + j);
+        for (size_t i = m - 1; i > 0; --i)
+          val = simd::fmadd(val, hv, simd::gather(&d[i - 1], row + j));
+      }
+      simd::store(yb + j, val);
+    }
+#endif
+    for (; j < nb; ++j) {
+      double const* dr = &d[row[j]];
+      double val = dr[m - 1];
+      for (size_t i = m - 1; i > 0; --i)
+        val = val * h[j] + dr[i - 1];
+      yb[j] = val;
+    }
+  }
+}
+
 double PiecewisePolynomial::integral(double a, double b) const
 {
   int isign(1);     // the sign of the integral
@@ -57,9 +156,11 @@ double PiecewisePolynomial::integral(double a, double b) const
   ptrdiff_t idxBkpt0 = index(a);
   ptrdiff_t idxBkpt1 = index(b);
   if (idxBkpt0 == idxBkpt1) {
-    // both a and b are between two breakpoints or outside the bkpt range
-    size_t i = idxBkpt0 < 0 ? 0 : idxBkpt0; // if a and b are both to the left of the first bkpt
-    return isign * c_(0, i) * (b - a); // constant times (b-a)
+    // both a and b are to the left of the first bkpt: constant times (b-a)
+    if (idxBkpt0 < 0)
+      return isign * c_(0, 0) * (b - a);
+    // both a and b are between two breakpoints or to the right of the last one
+    return isign * (primitive(idxBkpt0, b - x_(idxBkpt0), 1) - primitive(idxBkpt0, a - x_(idxBkpt0), 1));
   }
 
   double val(0.0);  // the value of the integral
@@ -87,65 +188,105 @@ double PiecewisePolynomial::integral(double a, double b) const
 }
 
 
-PiecewisePolynomial PiecewisePolynomial::operator+(PiecewisePolynomial const& p) const
+void PiecewisePolynomial::shiftedCoefficients(ptrdiff_t xIdx, double z, double* a) const
 {
-  size_t n = size() + p.size();               // the sum has at most n breakpoints
-  size_t ord = std::max(order(), p.order());  // the sum has order the max of the two orders
-  Vector bkpts(n);                            // the breakpoints of the sum
-  // merge the breakpoints
-  Vector::const_iterator bkend = std::set_union(x_.begin(), x_.end(),
-    p.breakPoints().begin(), p.breakPoints().end(), bkpts.begin());
-  Vector::const_iterator bkbeg = bkpts.begin();
-
-  PiecewisePolynomial psum(bkbeg, bkend, ord);
-  size_t nbks = psum.size();        // number of unique breakpoints
-  Vector tval(nbks), pval(nbks);
-
-  // polynomial summation; compute derivatives of all orders and add them
-  for (size_t i = 0; i <= ord; ++i) {
-    eval(bkbeg, bkend, tval.begin(), i);
-    p.eval(bkbeg, bkend, pval.begin(), i);
-    size_t fct = factorial(i);
-    Matrix::row_iterator rit = psum.coeff_begin(i);
-    for (size_t j = 0; j < nbks; ++j) {
-      *rit += (tval(j) + pval(j)) / fct;
-      ++rit;
-    }
+  size_t n(size());
+  size_t ord(order());
+  std::fill(a, a + ord + 1, 0.0);
+  if (xIdx < 0 || size_t(xIdx) + 1 == n) {
+    a[0] = c_(0, xIdx < 0 ? 0 : n - 1);   // flat extrapolation
+    return;
+  }
+  for (size_t j = 0; j <= ord; ++j)
+    a[j] = c_(j, xIdx);
+  // Taylor shift by repeated synthetic division, O(ord^2)
+  double h = z - x_(xIdx);
+  if (h != 0.0) {
+    for (size_t k = 0; k < ord; ++k)
+      for (size_t j = ord - 1; j + 1 > k; --j)
+        a[j] += h * a[j + 1];
+  }
+}
+
+template<typename OP>
+PiecewisePolynomial PiecewisePolynomial::merge(PiecewisePolynomial const& p, size_t ord, OP op) const
+{
+  Vector bkpts(size() + p.size());
+  Vector::iterator bkend = std::set_union(x_.begin(), x_.end(),
+    p.x_.begin(), p.x_.end(), bkpts.begin());
+  PiecewisePolynomial res(bkpts.begin(), bkend, ord);
+
+  std::vector<double> a(order() + 1), b(p.order() + 1);
+  ptrdiff_t i = -1, j = -1;   // the intervals of this and p
+  ptrdiff_t n = size(), m = p.size();
+  for (size_t k = 0; k < res.size(); ++k) {
+    double z = res.x_(k);
+    if (i + 1 < n && x_(i + 1) == z)
+      ++i;
+    if (j + 1 < m && p.x_(j + 1) == z)
+      ++j;
+    shiftedCoefficients(i, z, a.data());
+    p.shiftedCoefficients(j, z, b.data());
+    op(a.data(), b.data(), res.c_.colptr(k));
   }
-  return psum;
+  return res;
+}
+
+PiecewisePolynomial PiecewisePolynomial::operator+(PiecewisePolynomial const& p) const
+{
+  size_t ordA = order(), ordB = p.order();
+  return merge(p, std::max(ordA, ordB), [ordA, ordB](double const* a, double const* b, double* c) {
+    for (size_t j = 0; j <= ordA; ++j)
+      c[j] += a[j];
+    for (size_t j = 0; j <= ordB; ++j)
+      c[j] += b[j];
+  });
 }
 
 PiecewisePolynomial PiecewisePolynomial::operator*(PiecewisePolynomial const& p) const
 {
-  size_t n = size() + p.size();               // the product has at most n breakpoints
-  size_t ord = order() + p.order();           // the product has order the sum of the orders
-  Vector bkpts(n);                            // the breakpoints of the product
-  // merge the breakpoints
-  Vector::const_iterator bkend = std::set_union(x_.begin(), x_.end(),
-    p.breakPoints().begin(), p.breakPoints().end(), bkpts.begin());
-  Vector::const_iterator bkbeg = bkpts.begin();
-
-  PiecewisePolynomial pprod(bkbeg, bkend, ord);
-  size_t nbks = pprod.size();        // number of unique breakpoints
-  Vector tval(nbks), pval(nbks);
-
-  // polynomial multiplication: using convolution of coefficients
-  for (size_t i = 0; i <= ord; ++i) {
-    Matrix::row_iterator rit = pprod.coeff_begin(i);
-    for (size_t k = 0; k <= i; ++k) {
-      eval(bkbeg, bkend, tval.begin(), k);
-      p.eval(bkbeg, bkend, pval.begin(), i - k);
-      size_t fact1 = factorial(i);
-      size_t fact2 = factorial(i - k);
-      for (size_t j = 0; j < nbks; ++j) {
-        double tmp = tval[j] / fact1;
-        tmp *= pval[j] / fact2;
-        *rit += tmp;
-        ++rit;
-      }
-    }
+  size_t ordA = order(), ordB = p.order();
+  // the coefficients of the product are the convolution of the coefficients
+  return merge(p, ordA + ordB, [ordA, ordB](double const* a, double const* b, double* c) {
+    for (size_t j = 0; j <= ordA; ++j)
+      for (size_t l = 0; l <= ordB; ++l)
+        c[j + l] += a[j] * b[l];
+  });
+}
+
+PiecewisePolynomial& PiecewisePolynomial::operator+=(PiecewisePolynomial const& p)
+{
+  if (p.order() > order() || !std::includes(x_.begin(), x_.end(), p.x_.begin(), p.x_.end()))
+    return *this = *this + p;
+
+  // the breakpoints of p are breakpoints of this: add p in place
+  std::vector<double> b(p.order() + 1);
+  ptrdiff_t j = -1, m = p.size();
+  for (size_t k = 0; k < size(); ++k) {
+    if (j + 1 < m && p.x_(j + 1) == x_(k))
+      ++j;
+    p.shiftedCoefficients(j, x_(k), b.data());
+    for (size_t l = 0; l <= p.order(); ++l)
+      c_(l, k) += b[l];
+  }
+  return *this;
+}
+
+PiecewisePolynomial& PiecewisePolynomial::operator*=(PiecewisePolynomial const& p)
+{
+  if (p.order() > 0 || !std::includes(x_.begin(), x_.end(), p.x_.begin(), p.x_.end()))
+    return *this = *this * p;
+
+  // p is piecewise constant on the breakpoints of this: scale in place
+  ptrdiff_t j = -1, m = p.size();
+  for (size_t k = 0; k < size(); ++k) {
+    if (j + 1 < m && p.x_(j + 1) == x_(k))
+      ++j;
+    double scale = p.c_(0, std::max<ptrdiff_t>(j, 0));
+    for (size_t l = 0; l <= order(); ++l)
+      c_(l, k) *= scale;
   }
-  return pprod;
+  return *this;
 }
 
 END_NAMESPACE(qf)
@@ -9,10 +9,15 @@
 #include <qflib/defines.hpp>
 #include <qflib/exception.hpp>
 #include <qflib/math/matrix.hpp>
+#include <qflib/math/interpol/breakpointindex.hpp>
 
 #include <cmath>
 #include <algorithm>
 #include <functional>
+#include <iterator>
+#include <numeric>
+#include <type_traits>
+#include <vector>
 
 BEGIN_NAMESPACE(qf)
 
@@ -22,6 +27,8 @@ BEGIN_NAMESPACE(qf)
   Therefore, the curve is right continuous, i.e. f(x_i) = lim p_i(x_i + \epsilon), with positive \epsilon -> 0.
   Outside the range of the breakpoints the curve is extrapolated flat.
   The order of the curve is the highest polynomial order of its components.
+  The intervals of points are found with a BreakpointIndex built with the breakpoints;
+  setBreakPoint() discards it until reindex() is called.
 */
 class PiecewisePolynomial
 {
@@ -36,7 +43,7 @@ public:
   PiecewisePolynomial(ITER xFirst, ITER xLast, size_t order);
 
   /** Special ctor from breakpoints and values;
-      order = 0 piecewise constant, order = 1 linear continuous */
+      order = 0 piecewise constant, order = 1 linear continuous; for cubic splines see splines.hpp */
   template<typename XITER, typename YITER>
   PiecewisePolynomial(XITER xFirst, XITER xLast, YITER yFirst, size_t order);
 
@@ -54,8 +61,10 @@ public:
 
   /** Read access by index i */
   double breakPoint(size_t i) const { return x_(i); }
-  /** Write access by index i */
-  void setBreakPoint(size_t i, double val) { x_(i) = val; }
+  /** Write access by index i; the breakpoint search falls back to binary search until reindex() */
+  void setBreakPoint(size_t i, double val) { x_(i) = val; bkptIndex_.clear(); }
+  /** Rebuilds the breakpoint search index, after changes by setBreakPoint() */
+  void reindex() { bkptIndex_.build(x_.memptr(), x_.n_elem); }
 
   /** Read-only access to breakpoints */
   Vector const& breakPoints() const { return x_; }
@@ -95,11 +104,22 @@ public:
   template<typename XITER, typename YITER>
   void eval(XITER const xFirst, XITER const xLast, YITER yFirst, size_t k = 0) const;
 
+  /** Evaluate at the nx points x[0, nx), writing the results to y[0, nx)
+        k = 0 : y(x)
+        k > 0 : k-th left derivative at x
+      If the points are sorted, their intervals are found by advancing one index, otherwise by
+      binary search. The coefficients are scaled for the derivative once per call, and the
+      polynomials are evaluated several points at a time by Horner's rule in SIMD registers,
+      so the results may differ from the scalar eval in the last bits.
+  */
+  void eval(size_t nx, double const* x, double* y, size_t k = 0) const;
+
   /** Integrate between a and b */
   double integral(double a, double b) const;
 
   /** Integrate from xStart to each x in [xFirst, xLast)
-    If stepwise = true then integration
+    If stepwise = true then integration is from the previous x (from xStart for the first one)
+    The breakpoints and the x's are swept together in O(n + m); unsorted x's are sorted first.
     The results will be written by advancing yFirst;
     It assumes that [yFirst, yFirst + (xLast - xFirst)) is a valid range.
   */
@@ -119,10 +139,17 @@ public:
 
   // Polynomial algebra
 
-  /** Add p to this */
+  /** Add p to this
+      The breakpoints are merged and the coefficients of each piece are shifted to the merged
+      breakpoints in one pass, in O((n + m) ord^2).
+  */
   PiecewisePolynomial operator+(PiecewisePolynomial const& p) const;
-  /** Multiply p with this */
+  /** Multiply p with this; see operator+ */
   PiecewisePolynomial operator*(PiecewisePolynomial const& p) const;
+  /** Add p to this, in place if the breakpoints of p are breakpoints of this and its order is not higher */
+  PiecewisePolynomial& operator+=(PiecewisePolynomial const& p);
+  /** Multiply this with p, in place if p is piecewise constant on breakpoints of this */
+  PiecewisePolynomial& operator*=(PiecewisePolynomial const& p);
 
   // Calculus
 
@@ -145,7 +172,7 @@ protected:
   // It returns -1 if x < x[0] 
   inline ptrdiff_t index(double x) const
   {
-    return std::upper_bound(x_.begin(), x_.end(), x) - x_.begin() - 1;
+    return bkptIndex_.find(x_.memptr(), x_.n_elem, x);
   }
 
   // Helper function for computing factorials
@@ -160,9 +187,20 @@ protected:
   // Helper function for computing primitives. It returns the integral of p at x_[xIdx] + h
   double primitive(size_t xIdx, double h, size_t k) const;
 
+  // Writes to a[0, order()] the coefficients of the piece of interval xIdx in powers of x - z;
+  // xIdx = -1 and the last interval are the flat extrapolations
+  void shiftedCoefficients(ptrdiff_t xIdx, double z, double* a) const;
+
+  // Returns the polynomial of order ord on the union of the breakpoints of this and p, calling
+  // op(a, b, c) on each interval with a, b the coefficients of this and p at its left breakpoint
+  // and c the zero coefficients of the result
+  template<typename OP>
+  PiecewisePolynomial merge(PiecewisePolynomial const& p, size_t ord, OP op) const;
+
   // state
   Vector x_;  // breakpoints
   Matrix c_;  // polynomial coefficients
+  BreakpointIndex bkptIndex_;  // search accelerator for x_
 
 };
 
@@ -198,14 +236,14 @@ inline double PiecewisePolynomial::primitive(size_t xIdx, double h, size_t k) co
   }
   else {
     //  the integration range is inside the breakpoint domain
-    ptrdiff_t i;
-    size_t factnp1 = factorial(order() + 1);
-    for (i = ord + ik; i >= ik; --i) {
-      factnp1 /= (i + k + 1);
-      val = c_(i - ik, xIdx) + val * h / (i + 1);
+    //  the k-th primitive of sum_j c_j h^j is sum_j c_j h^(j+k) j!/(j+k)!
+    for (ptrdiff_t j = ord; j >= 0; --j) {
+      double scale = 1.0;
+      for (ptrdiff_t i = j + 1; i <= j + ik; ++i)
+        scale *= i;
+      val = val * h + c_(j, xIdx) / scale;
     }
-    for (; i >= 0; --i)
-      val = val * h / (i + 1);
+    val *= std::pow(h, ik);
   }
   return val;
 }
@@ -217,6 +255,7 @@ PiecewisePolynomial::PiecewisePolynomial(ITER xFirst, ITER xLast, size_t order)
 {
   std::copy(xFirst, xLast, x_.begin());
   assertBreakpointOrder();
+  reindex();
 }
 
 template<typename XITER, typename YITER>
@@ -226,6 +265,7 @@ PiecewisePolynomial::PiecewisePolynomial(XITER xFirst, XITER xLast, YITER yFirst
   QF_ASSERT(order < 2, "PiecewisePolynomial: only 0th and 1st order polynomials can be constructed from values");
   std::copy(xFirst, xLast, x_.begin());
   assertBreakpointOrder();
+  reindex();
 
   size_t n = xLast - xFirst;
   for (size_t j = 0; j < n; ++j)
@@ -247,6 +287,8 @@ inline void PiecewisePolynomial::setBreakPoints(ITER xFirst, ITER xLast, size_t
 {
   x_.resize(xLast - xFirst);
   std::copy(xFirst, xLast, x_.begin());
+  assertBreakpointOrder();
+  reindex();
 }
 
 
@@ -259,11 +301,17 @@ inline void PiecewisePolynomial::eval(XITER xFirst,
   if (xFirst == xLast)
     return;		// nothing to do
 
-  XITER xit = xFirst;
-  YITER yit = yFirst;
-  for (; xit < xLast; ++xit, ++yit)
-    *yit = eval(*xit, k);
-
+  size_t nx = std::distance(xFirst, xLast);
+  if constexpr (std::contiguous_iterator<XITER> && std::contiguous_iterator<YITER>
+                && std::is_same_v<std::iter_value_t<XITER>, double>
+                && std::is_same_v<std::iter_value_t<YITER>, double>) {
+    eval(nx, std::to_address(xFirst), std::to_address(yFirst), k);
+  }
+  else {
+    std::vector<double> xbuf(xFirst, xLast), ybuf(nx);
+    eval(nx, xbuf.data(), ybuf.data(), k);
+    std::copy(ybuf.begin(), ybuf.end(), yFirst);
+  }
 }
 
 template<typename XITER, typename YITER>
@@ -273,21 +321,57 @@ inline void PiecewisePolynomial::integral(double xStart,
   YITER yFirst,
   bool stepwise) const
 {
-  // This is not an optimal implementation
-  // We iterate over common bkpts for each integration limit x. 
-  // TODO: A better implementation is to iterate first over breakpoints.
+  // Sweep the breakpoints and the integration limits together, in increasing order,
+  // accumulating the integral from x_(0); this costs O(n + m) for sorted limits.
+  // Unsorted limits are visited through a sorted permutation.
   if (xFirst == xLast)
     return;		// nothing to do
 
-  XITER xit = xFirst;
-  YITER yit = yFirst;
-  for (; xit < xLast; ++xit, ++yit)
-    *yit = integral(xStart, *xit);
+  size_t m = xLast - xFirst;
+  bool sorted = std::is_sorted(xFirst, xLast);
+  std::vector<size_t> perm;
+  if (!sorted) {
+    perm.resize(m);
+    std::iota(perm.begin(), perm.end(), size_t(0));
+    std::sort(perm.begin(), perm.end(),
+      [xFirst](size_t i, size_t j) { return *(xFirst + i) < *(xFirst + j); });
+  }
+
+  size_t n = size();
+  size_t idx = 0;       // the breakpoint to the left of the current limit
+  double cum = 0.0;     // the integral from x_(0) to x_(idx)
+  // the integral from x_(0) to x, for x not to the left of the previous one
+  auto sweep = [&](double x) {
+    if (x < x_(0))
+      return c_(0, 0) * (x - x_(0));   // flat extrapolation
+    while (idx + 1 < n && x_(idx + 1) <= x) {
+      cum += primitive(idx, x_(idx + 1) - x_(idx), 1);
+      ++idx;
+    }
+    return cum + primitive(idx, x - x_(idx), 1);
+  };
+
+  // xStart is swept in its place among the limits
+  double fstart = 0.0;
+  bool startDone = false;
+  for (size_t k = 0; k < m; ++k) {
+    size_t j = sorted ? k : perm[k];
+    double x = *(xFirst + j);
+    if (!startDone && xStart <= x) {
+      fstart = sweep(xStart);
+      startDone = true;
+    }
+    *(yFirst + j) = sweep(x);
+  }
+  if (!startDone)
+    fstart = sweep(xStart);
+  for (size_t j = 0; j < m; ++j)
+    *(yFirst + j) -= fstart;
+
   // if stepwise is true, take adjacent differences
   if (stepwise) {
-    --yit; --xit;
-    for (; xit != xFirst; --xit, --yit)
-      *yit -= *(yit - 1);
+    for (size_t j = m - 1; j > 0; --j)
+      *(yFirst + j) -= *(yFirst + j - 1);
   }
   return;
 }
@@ -0,0 +1,155 @@
+/**
+@file  splines.cpp
+@brief Implementation of the cubic spline constructors
+*/
+
+#include <qflib/math/interpol/splines.hpp>
+#include <qflib/threadpool.hpp>
+
+#include <cmath>
+
+BEGIN_NAMESPACE(qf)
+
+namespace {
+
+// Checks the knots of a spline
+void assertKnots(size_t n, double const* x)
+{
+  QF_ASSERT(n >= 2, "spline: at least two knots are required");
+  for (size_t i = 0; i + 1 < n; ++i)
+    QF_ASSERT(x[i] < x[i + 1], "spline: knots must be in strict increasing order");
+}
+
+// Sets the coefficients of curve to the cubic Hermite interpolant of values y and slopes d at its breakpoints;
+// the last interval is the flat extrapolation
+void setHermite(double const* y, double const* d, PiecewisePolynomial& curve)
+{
+  size_t n = curve.size();
+  for (size_t i = 0; i + 1 < n; ++i) {
+    double h = curve.breakPoint(i + 1) - curve.breakPoint(i);
+    double delta = (y[i + 1] - y[i]) / h;
+    curve.setCoefficient(0, i, y[i]);
+    curve.setCoefficient(1, i, d[i]);
+    curve.setCoefficient(2, i, (3.0 * delta - 2.0 * d[i] - d[i + 1]) / h);
+    curve.setCoefficient(3, i, (d[i] + d[i + 1] - 2.0 * delta) / (h * h));
+  }
+  curve.setCoefficient(0, n - 1, y[n - 1]);
+}
+
+} // anonymous namespace
+
+CubicSplineBuilder::CubicSplineBuilder(size_t n, double const* x, SplineBoundary boundary)
+  : boundary_(boundary), h_(n > 0 ? n - 1 : 0), proto_(x, x + n, 3)
+{
+  assertKnots(n, x);
+  for (size_t i = 0; i + 1 < n; ++i)
+    h_[i] = x[i + 1] - x[i];
+
+  // equations for the second derivatives M at the knots:
+  // h[i-1] M[i-1] + 2 (h[i-1] + h[i]) M[i] + h[i] M[i+1] = 6 (delta[i] - delta[i-1])
+  std::vector<double> lower(n, 0.0), diag(n), upper(n, 0.0);
+  for (size_t i = 1; i + 1 < n; ++i) {
+    lower[i] = h_[i - 1];
+    diag[i] = 2.0 * (h_[i - 1] + h_[i]);
+    upper[i] = h_[i];
+  }
+  if (boundary_ == SplineBoundary::NATURAL) {
+    diag[0] = diag[n - 1] = 1.0;   // M = 0 at the ends
+  }
+  else {
+    diag[0] = 2.0 * h_[0];
+    upper[0] = h_[0];
+    lower[n - 1] = h_[n - 2];
+    diag[n - 1] = 2.0 * h_[n - 2];
+  }
+  solver_.factor(n, lower.data(), diag.data(), upper.data());
+}
+
+void CubicSplineBuilder::fill(double const* y, double leftSlope, double rightSlope, std::vector<double>& m,
+                              PiecewisePolynomial& curve) const
+{
+  size_t n = size();
+  m.resize(n);
+  double deltaPrev = (y[1] - y[0]) / h_[0];
+  for (size_t i = 1; i + 1 < n; ++i) {
+    double delta = (y[i + 1] - y[i]) / h_[i];
+    m[i] = 6.0 * (delta - deltaPrev);
+    deltaPrev = delta;
+  }
+  if (boundary_ == SplineBoundary::NATURAL) {
+    m[0] = m[n - 1] = 0.0;
+  }
+  else {
+    m[0] = 6.0 * ((y[1] - y[0]) / h_[0] - leftSlope);
+    m[n - 1] = 6.0 * (rightSlope - (y[n - 1] - y[n - 2]) / h_[n - 2]);
+  }
+  solver_.solve(m.data(), m.data());
+
+  for (size_t i = 0; i + 1 < n; ++i) {
+    double h = h_[i];
+    double delta = (y[i + 1] - y[i]) / h;
+    curve.setCoefficient(0, i, y[i]);
+    curve.setCoefficient(1, i, delta - h * (2.0 * m[i] + m[i + 1]) / 6.0);
+    curve.setCoefficient(2, i, 0.5 * m[i]);
+    curve.setCoefficient(3, i, (m[i + 1] - m[i]) / (6.0 * h));
+  }
+  curve.setCoefficient(0, n - 1, y[n - 1]);
+}
+
+PiecewisePolynomial CubicSplineBuilder::build(double const* y, double leftSlope, double rightSlope) const
+{
+  PiecewisePolynomial curve(proto_);
+  std::vector<double> m;
+  fill(y, leftSlope, rightSlope, m, curve);
+  return curve;
+}
+
+void CubicSplineBuilder::build(size_t nCurves, double const* y, PiecewisePolynomial* curves,
+                               double const* leftSlope, double const* rightSlope) const
+{
+  size_t n = size();
+  threadPool().parallelFor(nCurves, [&](size_t k) {
+    std::vector<double> m;
+    curves[k] = proto_;
+    fill(y + k * n, leftSlope ? leftSlope[k] : 0.0, rightSlope ? rightSlope[k] : 0.0, m, curves[k]);
+  });
+}
+
+PiecewisePolynomial cubicSpline(size_t n, double const* x, double const* y,
+                                SplineBoundary boundary, double leftSlope, double rightSlope)
+{
+  return CubicSplineBuilder(n, x, boundary).build(y, leftSlope, rightSlope);
+}
+
+PiecewisePolynomial hermiteSpline(size_t n, double const* x, double const* y, double const* dydx)
+{
+  assertKnots(n, x);
+  PiecewisePolynomial curve(x, x + n, 3);
+  setHermite(y, dydx, curve);
+  return curve;
+}
+
+PiecewisePolynomial monotoneSpline(size_t n, double const* x, double const* y)
+{
+  assertKnots(n, x);
+  std::vector<double> h(n - 1), delta(n - 1), d(n);
+  for (size_t i = 0; i + 1 < n; ++i) {
+    h[i] = x[i + 1] - x[i];
+    delta[i] = (y[i + 1] - y[i]) / h[i];
+  }
+  d[0] = delta[0];
+  d[n - 1] = delta[n - 2];
+  for (size_t i = 1; i + 1 < n; ++i) {
+    if (delta[i - 1] * delta[i] <= 0.0)
+      d[i] = 0.0;   // local extremum
+    else {
+      double w1 = 2.0 * h[i] + h[i - 1], w2 = h[i] + 2.0 * h[i - 1];
+      d[i] = (w1 + w2) / (w1 / delta[i - 1] + w2 / delta[i]);
+    }
+  }
+  PiecewisePolynomial curve(x, x + n, 3);
+  setHermite(y, d.data(), curve);
+  return curve;
+}
+
+END_NAMESPACE(qf)
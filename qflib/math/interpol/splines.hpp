@@ -0,0 +1,78 @@
+/**
+@file  splines.hpp
+@brief Cubic spline constructors for PiecewisePolynomial
+*/
+
+#ifndef QF_SPLINES_HPP
+#define QF_SPLINES_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <qflib/math/interpol/piecewisepolynomial.hpp>
+#include <qflib/math/linalg/tridiagonal.hpp>
+#include <vector>
+
+BEGIN_NAMESPACE(qf)
+
+/** The end conditions of a cubic spline */
+enum class SplineBoundary
+{
+  NATURAL,   // zero second derivatives at both ends
+  CLAMPED    // given first derivatives at both ends
+};
+
+/** Builds interpolating cubic splines on a fixed set of knots.
+    The tridiagonal system for the second derivatives at the knots depends only on the knots,
+    so it is factored once by the ctor; each curve then costs one O(n) solve, with the
+    coefficients written directly to a copy of a prototype curve.
+    The splines are PiecewisePolynomial objects of order 3, extrapolated flat outside the knots.
+*/
+class CubicSplineBuilder
+{
+public:
+  /** Ctor from the n >= 2 strictly increasing knots x[0, n) */
+  CubicSplineBuilder(size_t n, double const* x, SplineBoundary boundary = SplineBoundary::NATURAL);
+
+  /** Returns the number of knots */
+  size_t size() const { return h_.size() + 1; }
+
+  /** Returns the spline through the values y[0, n) at the knots;
+      the end slopes are only used by clamped splines
+  */
+  PiecewisePolynomial build(double const* y, double leftSlope = 0.0, double rightSlope = 0.0) const;
+
+  /** Builds nCurves splines, curve k through the values y[k * n, (k + 1) * n), into curves[0, nCurves).
+      leftSlope and rightSlope hold the end slopes of each curve for clamped splines; null means zero.
+      The curves are built in parallel on threadPool().
+  */
+  void build(size_t nCurves, double const* y, PiecewisePolynomial* curves,
+             double const* leftSlope = nullptr, double const* rightSlope = nullptr) const;
+
+private:
+  // Writes the coefficients of the spline through y to curve, using m as work space
+  void fill(double const* y, double leftSlope, double rightSlope, std::vector<double>& m,
+            PiecewisePolynomial& curve) const;
+
+  SplineBoundary boundary_;
+  std::vector<double> h_;       // knot spacings
+  TridiagonalSolver solver_;    // factored system for the second derivatives
+  PiecewisePolynomial proto_;   // the knots with zero coefficients
+};
+
+/** Interpolating cubic spline through (x[i], y[i]), i in [0, n); see CubicSplineBuilder */
+PiecewisePolynomial cubicSpline(size_t n, double const* x, double const* y,
+                                SplineBoundary boundary = SplineBoundary::NATURAL,
+                                double leftSlope = 0.0, double rightSlope = 0.0);
+
+/** Cubic Hermite spline through (x[i], y[i]) with first derivatives dydx[i], i in [0, n) */
+PiecewisePolynomial hermiteSpline(size_t n, double const* x, double const* y, double const* dydx);
+
+/** Monotone cubic Hermite spline through (x[i], y[i]), i in [0, n).
+    The slopes are the weighted harmonic means of the adjacent secants (Fritsch and Butland, 1984),
+    zero at local extrema, so the spline is monotone wherever the data are.
+*/
+PiecewisePolynomial monotoneSpline(size_t n, double const* x, double const* y);
+
+END_NAMESPACE(qf)
+
+#endif // QF_SPLINES_HPP
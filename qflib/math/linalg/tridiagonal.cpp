@@ -0,0 +1,46 @@
+/**
+@file  tridiagonal.cpp
+@brief Implementation of the tridiagonal solver
+*/
+
+#include <qflib/math/linalg/tridiagonal.hpp>
+
+BEGIN_NAMESPACE(qf)
+
+void TridiagonalSolver::factor(size_t n, double const* lower, double const* diag, double const* upper)
+{
+  QF_ASSERT(n > 0, "TridiagonalSolver: the system must have at least one equation");
+  lower_.assign(n, 0.0);
+  upper_.assign(n, 0.0);
+  invPivot_.assign(n, 0.0);
+
+  double pivot = diag[0];
+  for (size_t i = 0; i < n; ++i) {
+    if (i > 0) {
+      lower_[i] = lower[i];
+      pivot = diag[i] - lower[i] * upper_[i - 1];
+    }
+    QF_ASSERT(pivot != 0.0, "TridiagonalSolver: zero pivot in row " + std::to_string(i));
+    invPivot_[i] = 1.0 / pivot;
+    if (i + 1 < n)
+      upper_[i] = upper[i] * invPivot_[i];
+  }
+}
+
+void TridiagonalSolver::solve(double const* d, double* x) const
+{
+  size_t n = invPivot_.size();
+  QF_ASSERT(n > 0, "TridiagonalSolver: the matrix has not been factored");
+  // forward substitution
+  double y = d[0] * invPivot_[0];
+  x[0] = y;
+  for (size_t i = 1; i < n; ++i) {
+    y = (d[i] - lower_[i] * y) * invPivot_[i];
+    x[i] = y;
+  }
+  // back substitution
+  for (size_t i = n - 1; i-- > 0; )
+    x[i] -= upper_[i] * x[i + 1];
+}
+
+END_NAMESPACE(qf)
@@ -0,0 +1,51 @@
+/**
+@file  tridiagonal.hpp
+@brief Direct solver of tridiagonal linear systems
+*/
+
+#ifndef QF_TRIDIAGONAL_HPP
+#define QF_TRIDIAGONAL_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <vector>
+
+BEGIN_NAMESPACE(qf)
+
+/** Solves tridiagonal systems A x = d by the Thomas algorithm, without pivoting.
+    The factorization of A is computed once by factor() and reused by every solve(),
+    which costs 3n multiplications and 2n additions.
+    The matrix should be diagonally dominant, as those from finite difference schemes are.
+*/
+class TridiagonalSolver
+{
+public:
+  /** Default ctor; factor() must be called before solve() */
+  TridiagonalSolver() {}
+
+  /** Ctor that factors the matrix; see factor() */
+  TridiagonalSolver(size_t n, double const* lower, double const* diag, double const* upper)
+  {
+    factor(n, lower, diag, upper);
+  }
+
+  /** Factors the n x n matrix with sub-diagonal lower[1, n), diagonal diag[0, n)
+      and super-diagonal upper[0, n-1); lower[0] and upper[n-1] are not used.
+  */
+  void factor(size_t n, double const* lower, double const* diag, double const* upper);
+
+  /** Returns the size of the factored system */
+  size_t size() const { return invPivot_.size(); }
+
+  /** Writes the solution of A x = d to x[0, n); x may be the same array as d */
+  void solve(double const* d, double* x) const;
+
+private:
+  std::vector<double> lower_;     // sub-diagonal
+  std::vector<double> upper_;     // super-diagonal divided by the pivot of its row
+  std::vector<double> invPivot_;  // inverse pivots
+};
+
+END_NAMESPACE(qf)
+
+#endif // QF_TRIDIAGONAL_HPP
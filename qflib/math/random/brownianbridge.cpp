@@ -0,0 +1,73 @@
+/**
+@file  brownianbridge.cpp
+@brief Implementation of the Brownian bridge construction
+*/
+
+#include <qflib/math/random/brownianbridge.hpp>
+#include <cmath>
+
+BEGIN_NAMESPACE(qf)
+
+BrownianBridge::BrownianBridge(Vector const& times)
+: times_(times.begin(), times.end())
+{
+  size_t n = times_.size();
+  QF_ASSERT(n > 0, "BrownianBridge: at least one time is required");
+  for (size_t i = 0; i < n; ++i)
+    QF_ASSERT(times_[i] > (i == 0 ? 0.0 : times_[i - 1]), "BrownianBridge: times must be positive and increasing");
+
+  bridgeIndex_.assign(n, 0);
+  leftIndex_.assign(n, 0);
+  rightIndex_.assign(n, 0);
+  leftWeight_.assign(n, 0.0);
+  rightWeight_.assign(n, 0.0);
+  stdDev_.assign(n, 0.0);
+
+  // the first normal sets the last point
+  std::vector<size_t> filled(n, 0);
+  filled[n - 1] = 1;
+  bridgeIndex_[0] = n - 1;
+  stdDev_[0] = sqrt(times_[n - 1]);
+
+  // each next normal fills the middle of the leftmost remaining gap [j, k), scanning left to right
+  std::vector<double> const& t = times_;
+  for (size_t i = 1, j = 0; i < n; ++i) {
+    while (filled[j])
+      ++j;
+    size_t k = j;
+    while (!filled[k])
+      ++k;
+    size_t l = j + ((k - 1 - j) >> 1);
+    filled[l] = 1;
+    bridgeIndex_[i] = l;
+    leftIndex_[i] = j;
+    rightIndex_[i] = k;
+    double tleft = j == 0 ? 0.0 : t[j - 1];
+    leftWeight_[i] = (t[k] - t[l]) / (t[k] - tleft);
+    rightWeight_[i] = (t[l] - tleft) / (t[k] - tleft);
+    stdDev_[i] = sqrt((t[l] - tleft) * (t[k] - t[l]) / (t[k] - tleft));
+    j = k + 1;
+    if (j >= n)
+      j = 0;
+  }
+}
+
+void BrownianBridge::buildPath(double const* z, double* w) const
+{
+  size_t n = times_.size();
+  w[n - 1] = stdDev_[0] * z[0];
+  for (size_t i = 1; i < n; ++i) {
+    size_t j = leftIndex_[i], k = rightIndex_[i], l = bridgeIndex_[i];
+    double wleft = j == 0 ? 0.0 : w[j - 1];
+    w[l] = leftWeight_[i] * wleft + rightWeight_[i] * w[k] + stdDev_[i] * z[i];
+  }
+}
+
+void BrownianBridge::buildPaths(size_t nPaths, double const* z, double* w) const
+{
+  size_t n = times_.size();
+  for (size_t p = 0; p < nPaths; ++p)
+    buildPath(z + p * n, w + p * n);
+}
+
+END_NAMESPACE(qf)
@@ -0,0 +1,48 @@
+/**
+@file  brownianbridge.hpp
+@brief Brownian bridge construction of Brownian motion paths
+*/
+
+#ifndef QF_BROWNIANBRIDGE_HPP
+#define QF_BROWNIANBRIDGE_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <qflib/math/matrix.hpp>
+#include <vector>
+
+BEGIN_NAMESPACE(qf)
+
+/** Builds standard Brownian motion paths on a time grid from independent standard normals,
+    in Brownian bridge order: the first normal sets the value at the last time, the next ones
+    fill the midpoints of the remaining intervals. With quasi-random normals this concentrates
+    the variance of the path on the first, best distributed, dimensions.
+*/
+class BrownianBridge
+{
+public:
+  /** Ctor from the times of the path, which must be positive and increasing */
+  explicit BrownianBridge(Vector const& times);
+
+  /** Returns the number of times */
+  size_t size() const { return times_.size(); }
+
+  /** Writes the values W(t_i) of the path built from the normals z[0, size) to w[0, size); z and w must not overlap */
+  void buildPath(double const* z, double* w) const;
+
+  /** Builds nPaths paths; z and w hold one path after the other, as returned by SobolSequence::next */
+  void buildPaths(size_t nPaths, double const* z, double* w) const;
+
+private:
+  std::vector<double> times_;
+  std::vector<size_t> bridgeIndex_;   // time filled by each normal
+  std::vector<size_t> leftIndex_;     // left end of its interval; 0 means the origin
+  std::vector<size_t> rightIndex_;    // right end of its interval
+  std::vector<double> leftWeight_;
+  std::vector<double> rightWeight_;
+  std::vector<double> stdDev_;
+};
+
+END_NAMESPACE(qf)
+
+#endif // QF_BROWNIANBRIDGE_HPP
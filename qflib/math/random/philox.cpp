@@ -0,0 +1,139 @@
+/**
+@file  philox.cpp
+@brief Implementation of the Philox4x32-10 random number generator
+*/
+
+#include <qflib/math/random/philox.hpp>
+#include <qflib/math/stats/normaldistribution.hpp>
+#include <algorithm>
+
+BEGIN_NAMESPACE(qf)
+
+namespace {
+
+// round multipliers and key increments (Weyl sequence)
+const std::uint32_t PHILOX_M0 = 0xD2511F53u;
+const std::uint32_t PHILOX_M1 = 0xCD9E8D57u;
+const std::uint32_t PHILOX_W0 = 0x9E3779B9u;
+const std::uint32_t PHILOX_W1 = 0xBB67AE85u;
+const int PHILOX_ROUNDS = 10;
+
+// Number of counters processed together by the array functions
+const size_t PHILOX_LANES = 64;
+
+// Uniform deviate in (0, 1) from the upper 52 of 64 bits. With 53 bits the largest x + 0.5
+// would need 54 bits and round to 2^53, giving 1.0; with 52 it is exact, 1 - 2^-53 at most.
+constexpr double toUniform(std::uint32_t hi, std::uint32_t lo)
+{
+  std::uint64_t x = ((std::uint64_t(hi) << 32) | lo) >> 12;
+  return (x + 0.5) * 0x1.0p-52;
+}
+
+static_assert(toUniform(0, 0) > 0.0, "Philox4x32: uniform deviates must be positive");
+static_assert(toUniform(0xFFFFFFFFu, 0xFFFFFFFFu) < 1.0, "Philox4x32: uniform deviates must be below 1");
+
+} // anonymous namespace
+
+void Philox4x32::generateBlock(std::uint64_t ctr, std::uint64_t stream, std::uint32_t const key[2],
+                               std::uint32_t out[4])
+{
+  std::uint32_t c0 = std::uint32_t(ctr), c1 = std::uint32_t(ctr >> 32);
+  std::uint32_t c2 = std::uint32_t(stream), c3 = std::uint32_t(stream >> 32);
+  std::uint32_t k0 = key[0], k1 = key[1];
+  for (int r = 0; r < PHILOX_ROUNDS; ++r) {
+    std::uint64_t p0 = std::uint64_t(PHILOX_M0) * c0;
+    std::uint64_t p1 = std::uint64_t(PHILOX_M1) * c2;
+    std::uint32_t n0 = std::uint32_t(p1 >> 32) ^ c1 ^ k0;
+    std::uint32_t n2 = std::uint32_t(p0 >> 32) ^ c3 ^ k1;
+    c1 = std::uint32_t(p1);
+    c3 = std::uint32_t(p0);
+    c0 = n0;
+    c2 = n2;
+    k0 += PHILOX_W0;
+    k1 += PHILOX_W1;
+  }
+  out[0] = c0;
+  out[1] = c1;
+  out[2] = c2;
+  out[3] = c3;
+}
+
+void Philox4x32::seed(std::uint64_t seed, std::uint64_t stream)
+{
+  key_[0] = std::uint32_t(seed);
+  key_[1] = std::uint32_t(seed >> 32);
+  stream_ = stream;
+  ctr_ = 0;
+  idx_ = 4;
+}
+
+void Philox4x32::discard(std::uint64_t n)
+{
+  std::uint64_t pos = position() + n;
+  ctr_ = pos / 4;
+  idx_ = 4;
+  if (pos % 4 != 0) {
+    generateBlock(ctr_, stream_, key_, buf_);
+    ++ctr_;
+    idx_ = unsigned(pos % 4);
+  }
+}
+
+void Philox4x32::uniforms(size_t n, double* u)
+{
+  size_t i = 0;
+  // finish the current block one output at a time
+  while (i < n && idx_ != 4) {
+    std::uint32_t hi = (*this)();
+    u[i++] = toUniform(hi, (*this)());
+  }
+
+  // whole blocks, two deviates each, in independent lanes
+  std::uint32_t c0[PHILOX_LANES], c1[PHILOX_LANES], c2[PHILOX_LANES], c3[PHILOX_LANES];
+  while (n - i >= 2) {
+    size_t nl = std::min(PHILOX_LANES, (n - i) / 2);
+    for (size_t j = 0; j < nl; ++j) {
+      std::uint64_t ctr = ctr_ + j;
+      c0[j] = std::uint32_t(ctr);
+      c1[j] = std::uint32_t(ctr >> 32);
+      c2[j] = std::uint32_t(stream_);
+      c3[j] = std::uint32_t(stream_ >> 32);
+    }
+    std::uint32_t k0 = key_[0], k1 = key_[1];
+    for (int r = 0; r < PHILOX_ROUNDS; ++r) {
+      for (size_t j = 0; j < nl; ++j) {
+        std::uint64_t p0 = std::uint64_t(PHILOX_M0) * c0[j];
+        std::uint64_t p1 = std::uint64_t(PHILOX_M1) * c2[j];
+        std::uint32_t n0 = std::uint32_t(p1 >> 32) ^ c1[j] ^ k0;
+        std::uint32_t n2 = std::uint32_t(p0 >> 32) ^ c3[j] ^ k1;
+        c1[j] = std::uint32_t(p1);
+        c3[j] = std::uint32_t(p0);
+        c0[j] = n0;
+        c2[j] = n2;
+      }
+      k0 += PHILOX_W0;
+      k1 += PHILOX_W1;
+    }
+    for (size_t j = 0; j < nl; ++j) {
+      u[i + 2 * j] = toUniform(c0[j], c1[j]);
+      u[i + 2 * j + 1] = toUniform(c2[j], c3[j]);
+    }
+    ctr_ += nl;
+    i += 2 * nl;
+  }
+
+  // odd tail
+  if (i < n) {
+    std::uint32_t hi = (*this)();
+    u[i] = toUniform(hi, (*this)());
+  }
+}
+
+void Philox4x32::normals(size_t n, double* z, InverseNormal::Precision prec)
+{
+  uniforms(n, z);
+  NormalDistribution normal;
+  normal.invcdf(n, z, z, prec);
+}
+
+END_NAMESPACE(qf)
@@ -0,0 +1,80 @@
+/**
+@file  philox.hpp
+@brief Counter-based Philox4x32-10 random number generator
+*/
+
+#ifndef QF_PHILOX_HPP
+#define QF_PHILOX_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <qflib/math/stats/inversenormal.hpp>
+#include <cstdint>
+#include <limits>
+
+BEGIN_NAMESPACE(qf)
+
+/** The Philox4x32-10 counter-based generator of Salmon et al., "Parallel random numbers:
+    as easy as 1, 2, 3" (SC11).
+    The n-th output is a bijection of the counter n / 4 under the key, so any position of any
+    stream is reached in O(1): a 64-bit seed is the key, a 64-bit stream id fills the upper half
+    of the counter and each stream has 2^66 outputs. Different (seed, stream) pairs give
+    independent sequences without any coordination between threads or processes.
+    Satisfies the UniformRandomBitGenerator requirements, with 32-bit outputs.
+*/
+class Philox4x32
+{
+public:
+  using result_type = std::uint32_t;
+
+  /** Ctor from the seed and the stream id */
+  explicit Philox4x32(std::uint64_t seed = 0, std::uint64_t stream = 0) { this->seed(seed, stream); }
+
+  /** Restarts the generator at the beginning of the given stream */
+  void seed(std::uint64_t seed, std::uint64_t stream = 0);
+
+  /** Returns the next 32-bit output */
+  result_type operator()()
+  {
+    if (idx_ == 4) {
+      generateBlock(ctr_, stream_, key_, buf_);
+      ++ctr_;
+      idx_ = 0;
+    }
+    return buf_[idx_++];
+  }
+
+  /** Skips the next n outputs in O(1) */
+  void discard(std::uint64_t n);
+
+  /** Returns the number of outputs drawn since the beginning of the stream */
+  std::uint64_t position() const { return ctr_ * 4 - (4 - idx_); }
+
+  /** Fills u[0, n) with uniform deviates in (0, 1) with 52 random bits, using two outputs per deviate.
+      The counters are processed in independent lanes the compiler can vectorize.
+  */
+  void uniforms(size_t n, double* u);
+
+  /** Fills z[0, n) with standard normal deviates, converted from uniforms() by the
+      array inverse normal cdf of NormalDistribution
+  */
+  void normals(size_t n, double* z, InverseNormal::Precision prec = InverseNormal::Precision::FULL);
+
+  static constexpr result_type min() { return 0; }
+  static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+  /** The Philox4x32-10 bijection: out = f(counter, key), counter = (ctr, stream) as four 32-bit words */
+  static void generateBlock(std::uint64_t ctr, std::uint64_t stream, std::uint32_t const key[2],
+                            std::uint32_t out[4]);
+
+private:
+  std::uint32_t key_[2];    // the seed
+  std::uint64_t stream_;    // upper half of the counter
+  std::uint64_t ctr_;       // lower half of the counter: the next block
+  std::uint32_t buf_[4];    // outputs of block ctr_ - 1
+  unsigned idx_;            // next output in buf_; 4 if empty
+};
+
+END_NAMESPACE(qf)
+
+#endif // QF_PHILOX_HPP
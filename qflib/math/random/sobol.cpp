@@ -0,0 +1,253 @@
+/**
+@file  sobol.cpp
+@brief Implementation of the Sobol low-discrepancy sequence
+*/
+
+#include <qflib/math/random/sobol.hpp>
+#include <qflib/math/random/philox.hpp>
+#include <qflib/math/random/soboltable.hpp>
+#include <fstream>
+#include <sstream>
+
+BEGIN_NAMESPACE(qf)
+
+namespace {
+
+// Product of polynomials a and b over GF(2), modulo the polynomial p of degree s
+inline std::uint64_t mulmod(std::uint64_t a, std::uint64_t b, std::uint64_t p, unsigned s)
+{
+  std::uint64_t r = 0;
+  while (b) {
+    if (b & 1)
+      r ^= a;
+    b >>= 1;
+    a <<= 1;
+    if ((a >> s) & 1)
+      a ^= p;
+  }
+  return r;
+}
+
+// x^e modulo p
+inline std::uint64_t powxmod(std::uint64_t e, std::uint64_t p, unsigned s)
+{
+  std::uint64_t r = 1, b = s > 1 ? 2 : (2 ^ p);
+  for (; e; e >>= 1) {
+    if (e & 1)
+      r = mulmod(r, b, p, s);
+    b = mulmod(b, b, p, s);
+  }
+  return r;
+}
+
+// Distinct prime factors of n
+std::vector<std::uint64_t> primeFactors(std::uint64_t n)
+{
+  std::vector<std::uint64_t> f;
+  for (std::uint64_t q = 2; q * q <= n; ++q) {
+    if (n % q == 0) {
+      f.push_back(q);
+      while (n % q == 0)
+        n /= q;
+    }
+  }
+  if (n > 1)
+    f.push_back(n);
+  return f;
+}
+
+// Enumerates the first n primitive polynomials over GF(2) by degree, then by coefficients.
+// A polynomial of degree s with non-zero constant term is primitive iff x has order 2^s - 1 modulo it.
+void primitivePolynomials(size_t n, std::vector<unsigned>& degrees, std::vector<std::uint32_t>& coeffs)
+{
+  for (unsigned s = 1; degrees.size() < n; ++s) {
+    std::uint64_t order = (std::uint64_t(1) << s) - 1;
+    std::vector<std::uint64_t> factors = primeFactors(order);
+    for (std::uint32_t a = 0; a < (1u << (s - 1)) && degrees.size() < n; ++a) {
+      std::uint64_t p = (std::uint64_t(1) << s) | (std::uint64_t(a) << 1) | 1;
+      if (powxmod(order, p, s) != 1)
+        continue;
+      bool primitive = true;
+      for (auto q : factors)
+        primitive = primitive && powxmod(order / q, p, s) != 1;
+      if (primitive) {
+        degrees.push_back(s);
+        coeffs.push_back(a);
+      }
+    }
+  }
+}
+
+// Bit reversal of a 32-bit integer
+inline std::uint32_t reverseBits(std::uint32_t x)
+{
+  x = ((x >> 1) & 0x55555555u) | ((x & 0x55555555u) << 1);
+  x = ((x >> 2) & 0x33333333u) | ((x & 0x33333333u) << 2);
+  x = ((x >> 4) & 0x0F0F0F0Fu) | ((x & 0x0F0F0F0Fu) << 4);
+  x = ((x >> 8) & 0x00FF00FFu) | ((x & 0x00FF00FFu) << 8);
+  return (x >> 16) | (x << 16);
+}
+
+// Nested uniform scrambling of the bits of x, after Burley, "Practical hash-based Owen scrambling" (2020)
+inline std::uint32_t owenScramble(std::uint32_t x, std::uint32_t seed)
+{
+  x = reverseBits(x);
+  x += seed;
+  x ^= x * 0x6c50b47cu;
+  x ^= x * 0xb82f1e52u;
+  x ^= x * 0xc7afe638u;
+  x ^= x * 0x8d22f6e6u;
+  return reverseBits(x);
+}
+
+// Number of trailing zero bits of n > 0
+inline unsigned trailingZeros(std::uint64_t n)
+{
+  unsigned c = 0;
+  while (!(n & 1)) {
+    n >>= 1;
+    ++c;
+  }
+  return c;
+}
+
+} // anonymous namespace
+
+SobolSequence::SobolSequence(size_t dim, Scrambling scrambling, std::uint64_t seed)
+: dim_(dim), scrambling_(scrambling), index_(0)
+{
+  QF_ASSERT(dim >= 1 && dim <= MAX_DEFAULT_DIMENSION,
+            "SobolSequence: dimension must be between 1 and " + std::to_string(MAX_DEFAULT_DIMENSION)
+            + "; higher dimensions need a direction number file");
+  std::vector<unsigned> degrees;
+  std::vector<std::uint32_t> coeffs;
+  primitivePolynomials(dim - 1, degrees, coeffs);
+
+  // the bundled Joe-Kuo initial direction numbers
+  std::vector<std::vector<std::uint32_t>> m(dim - 1);
+  std::uint16_t const* table = SOBOL_TABLE_M;
+  for (size_t d = 0; d + 1 < dim; ++d) {
+    m[d].assign(table, table + degrees[d]);
+    table += degrees[d];
+  }
+  init(degrees, coeffs, m, scrambling, seed);
+}
+
+SobolSequence::SobolSequence(size_t dim, std::string const& directionFile,
+                             Scrambling scrambling, std::uint64_t seed)
+: dim_(dim), scrambling_(scrambling), index_(0)
+{
+  QF_ASSERT(dim >= 1 && dim <= MAX_DIMENSION,
+            "SobolSequence: dimension must be between 1 and " + std::to_string(MAX_DIMENSION));
+  std::ifstream in(directionFile);
+  QF_ASSERT(in, "SobolSequence: cannot open direction number file " + directionFile);
+
+  std::vector<unsigned> degrees;
+  std::vector<std::uint32_t> coeffs;
+  std::vector<std::vector<std::uint32_t>> m;
+  std::string line;
+  std::getline(in, line);   // header
+  while (degrees.size() + 1 < dim && std::getline(in, line)) {
+    std::istringstream ss(line);
+    unsigned d, s;
+    std::uint32_t a;
+    if (!(ss >> d >> s >> a))
+      continue;
+    QF_ASSERT(d == degrees.size() + 2, "SobolSequence: dimensions out of order in " + directionFile);
+    QF_ASSERT(s >= 1 && s < NBITS, "SobolSequence: invalid degree in dimension " + std::to_string(d));
+    std::vector<std::uint32_t> md(s);
+    for (unsigned k = 0; k < s; ++k) {
+      QF_ASSERT(ss >> md[k], "SobolSequence: missing direction numbers in dimension " + std::to_string(d));
+      QF_ASSERT((md[k] & 1) && md[k] < (std::uint64_t(1) << (k + 1)),
+                "SobolSequence: invalid direction number in dimension " + std::to_string(d));
+    }
+    degrees.push_back(s);
+    coeffs.push_back(a);
+    m.push_back(md);
+  }
+  QF_ASSERT(degrees.size() + 1 == dim, "SobolSequence: " + directionFile + " has fewer than "
+            + std::to_string(dim) + " dimensions");
+  init(degrees, coeffs, m, scrambling, seed);
+}
+
+void SobolSequence::init(std::vector<unsigned> const& degrees, std::vector<std::uint32_t> const& coeffs,
+                         std::vector<std::vector<std::uint32_t>> const& m, Scrambling scrambling,
+                         std::uint64_t seed)
+{
+  v_.assign(dim_ * NBITS, 0);
+  // dimension 1: v_k = 2^(32 - k)
+  for (int k = 0; k < NBITS; ++k)
+    v_[k] = 1u << (NBITS - 1 - k);
+  for (size_t d = 1; d < dim_; ++d) {
+    std::uint32_t* v = &v_[d * NBITS];
+    unsigned s = degrees[d - 1];
+    std::uint32_t a = coeffs[d - 1];
+    for (unsigned k = 0; k < s && k < NBITS; ++k)
+      v[k] = m[d - 1][k] << (NBITS - 1 - k);
+    for (unsigned k = s; k < NBITS; ++k) {
+      v[k] = v[k - s] ^ (v[k - s] >> s);
+      for (unsigned i = 1; i < s; ++i)
+        if ((a >> (s - 1 - i)) & 1)
+          v[k] ^= v[k - i];
+    }
+  }
+
+  scramble_.assign(dim_, 0);
+  if (scrambling != Scrambling::NONE) {
+    Philox4x32 rng(seed);
+    for (auto& sc : scramble_)
+      sc = rng();
+  }
+  x_.assign(dim_, 0);
+  skipTo(0);
+}
+
+void SobolSequence::skipTo(std::uint64_t index)
+{
+  QF_ASSERT(index < (std::uint64_t(1) << NBITS), "SobolSequence: index must be less than 2^32");
+  std::uint64_t gray = index ^ (index >> 1);
+  for (size_t d = 0; d < dim_; ++d) {
+    std::uint32_t const* v = &v_[d * NBITS];
+    std::uint32_t x = 0;
+    for (int k = 0; k < NBITS; ++k)
+      if ((gray >> k) & 1)
+        x ^= v[k];
+    x_[d] = x;
+  }
+  index_ = index;
+}
+
+void SobolSequence::next(double* u)
+{
+  QF_ASSERT(index_ < (std::uint64_t(1) << NBITS), "SobolSequence: the sequence is exhausted");
+  switch (scrambling_) {
+  case Scrambling::NONE:
+    for (size_t d = 0; d < dim_; ++d)
+      u[d] = (x_[d] + 0.5) * 0x1.0p-32;
+    break;
+  case Scrambling::DIGITAL_SHIFT:
+    for (size_t d = 0; d < dim_; ++d)
+      u[d] = ((x_[d] ^ scramble_[d]) + 0.5) * 0x1.0p-32;
+    break;
+  case Scrambling::OWEN:
+    for (size_t d = 0; d < dim_; ++d)
+      u[d] = (owenScramble(x_[d], scramble_[d]) + 0.5) * 0x1.0p-32;
+    break;
+  }
+
+  // Gray code update: the next point differs in the direction number of the lowest zero bit of index_
+  ++index_;
+  if (index_ < (std::uint64_t(1) << NBITS)) {
+    unsigned c = trailingZeros(index_);
+    for (size_t d = 0; d < dim_; ++d)
+      x_[d] ^= v_[d * NBITS + c];
+  }
+}
+
+void SobolSequence::next(size_t nPoints, double* u)
+{
+  for (size_t i = 0; i < nPoints; ++i)
+    next(u + i * dim_);
+}
+
+END_NAMESPACE(qf)
@@ -0,0 +1,86 @@
+/**
+@file  sobol.hpp
+@brief Sobol low-discrepancy sequence with scrambling and skip-ahead
+*/
+
+#ifndef QF_SOBOL_HPP
+#define QF_SOBOL_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <qflib/math/random/soboltable.hpp>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+BEGIN_NAMESPACE(qf)
+
+/** The Sobol sequence in base 2 with 32-bit resolution, generated in Gray code order.
+    Dimension 1 is the van der Corput sequence. The primitive polynomials of the other dimensions
+    are enumerated by degree and coefficients, as in the tables of Joe and Kuo; their initial
+    direction numbers are either read from a file in the Joe-Kuo format
+    (e.g. new-joe-kuo-6.21201) or, by default, those of new-joe-kuo-6.21201 bundled up to
+    dimension MAX_DEFAULT_DIMENSION = 3667. Higher dimensions need the file.
+    Points are returned as uniforms (k + 0.5) / 2^32 in (0, 1), ready for the inverse normal cdf.
+    Without scrambling, the first point (index 0) has all coordinates at the lower edge and is
+    usually skipped with skipTo(1).
+*/
+class SobolSequence
+{
+public:
+  /** Randomization of the sequence */
+  enum class Scrambling
+  {
+    NONE,           // the plain sequence
+    DIGITAL_SHIFT,  // XOR with a random 32-bit integer per dimension
+    OWEN            // hash-based nested uniform scrambling (Burley 2020), with a random seed per dimension
+  };
+
+  /** Maximum dimension, as in the largest Joe-Kuo table */
+  static const size_t MAX_DIMENSION = 21201;
+
+  /** Maximum dimension with the bundled direction numbers */
+  static const size_t MAX_DEFAULT_DIMENSION = SOBOL_TABLE_DIMENSION;
+
+  /** Ctor with the bundled Joe-Kuo direction numbers, up to MAX_DEFAULT_DIMENSION; seed drives the scrambling */
+  explicit SobolSequence(size_t dim, Scrambling scrambling = Scrambling::NONE, std::uint64_t seed = 0);
+
+  /** Ctor with the direction numbers read from a file in the Joe-Kuo format:
+      a header line, then one line "d s a m_1 ... m_s" per dimension d >= 2.
+  */
+  SobolSequence(size_t dim, std::string const& directionFile,
+                Scrambling scrambling = Scrambling::NONE, std::uint64_t seed = 0);
+
+  /** Returns the dimension */
+  size_t dim() const { return dim_; }
+
+  /** Returns the index of the next point */
+  std::uint64_t index() const { return index_; }
+
+  /** Positions the sequence at the point with the given index, in O(32 * dim) */
+  void skipTo(std::uint64_t index);
+
+  /** Writes the next point to u[0, dim) */
+  void next(double* u);
+
+  /** Writes the next nPoints points to u, point after point: coordinate j of point i is u[i * dim + j] */
+  void next(size_t nPoints, double* u);
+
+private:
+  static const int NBITS = 32;
+
+  // fills v_ from the degree, coefficients and initial numbers of each dimension
+  void init(std::vector<unsigned> const& degrees, std::vector<std::uint32_t> const& coeffs,
+            std::vector<std::vector<std::uint32_t>> const& m, Scrambling scrambling, std::uint64_t seed);
+
+  size_t dim_;
+  std::vector<std::uint32_t> v_;         // direction numbers, NBITS per dimension
+  std::vector<std::uint32_t> x_;         // current integer point
+  std::vector<std::uint32_t> scramble_;  // shift or seed per dimension
+  Scrambling scrambling_;
+  std::uint64_t index_;                  // index of the next point
+};
+
+END_NAMESPACE(qf)
+
+#endif // QF_SOBOL_HPP
@@ -0,0 +1,32 @@
+/**
+@file  soboltable.hpp
+@brief The bundled initial direction numbers of the Sobol sequence
+*/
+
+#ifndef QF_SOBOLTABLE_HPP
+#define QF_SOBOLTABLE_HPP
+
+#include <qflib/defines.hpp>
+#include <cstddef>
+#include <cstdint>
+
+BEGIN_NAMESPACE(qf)
+
+/** Number of dimensions with bundled direction numbers, dimension 1 included */
+const size_t SOBOL_TABLE_DIMENSION = 3667;
+
+/** Number of entries of SOBOL_TABLE_M */
+const size_t SOBOL_TABLE_SIZE = 50807;
+
+/** The initial direction numbers m_1, ..., m_s of dimensions 2 to SOBOL_TABLE_DIMENSION, one
+    dimension after the other, from the file new-joe-kuo-6.21201 of S. Joe and F. Y. Kuo,
+    "Constructing Sobol sequences with better two-dimensional projections",
+    SIAM J. Sci. Comput. 30, 2635-2654 (2008), up to the last primitive polynomial of degree 15.
+    The degree s of dimension d is that of its primitive polynomial, the (d - 1)-th by degree and
+    coefficients.
+*/
+extern const std::uint16_t SOBOL_TABLE_M[SOBOL_TABLE_SIZE];
+
+END_NAMESPACE(qf)
+
+#endif // QF_SOBOLTABLE_HPP
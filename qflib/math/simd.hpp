@@ -0,0 +1,245 @@
+/**
+@file  simd.hpp
+@brief Thin wrappers over SIMD registers of doubles, used by the array kernels of the library.
+       The instruction set is selected at compile time (see QF_SIMD in the top level CMakeLists.txt).
+*/
+
+#ifndef QF_SIMD_HPP
+#define QF_SIMD_HPP
+
+#include <qflib/defines.hpp>
+
+/** @def   QF_SIMD_WIDTH
+ *  @brief Number of doubles processed per register: 8 with AVX-512, 4 with AVX2 and FMA, 1 otherwise.
+ *         When it is 1, the array kernels fall back to the scalar functions.
+ */
+#if defined(__AVX512F__)
+#define QF_SIMD_WIDTH 8
+#elif defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#define QF_SIMD_WIDTH 4
+#else
+#define QF_SIMD_WIDTH 1
+#endif
+
+#if QF_SIMD_WIDTH > 1
+
+// GCC 12 warns about the deliberately undefined pass-through operand of the AVX-512 intrinsics
+// (_mm512_undefined_pd), wherever they are inlined; the warning is reported in the header itself
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+#include <cstdint>
+
+BEGIN_NAMESPACE(qf)
+BEGIN_NAMESPACE(simd)
+
+///////////////////////////////////////////////////////////////////////////////
+// Instruction set specific primitives
+
+#if QF_SIMD_WIDTH == 8
+
+/** Register of doubles */
+using Vd = __m512d;
+/** Lane mask, the result of comparisons */
+using Md = __mmask8;
+
+inline Vd load(double const* p) { return _mm512_loadu_pd(p); }
+inline void store(double* p, Vd a) { _mm512_storeu_pd(p, a); }
+inline Vd set1(double a) { return _mm512_set1_pd(a); }
+/** Lanes p[idx[0]], ..., p[idx[7]] */
+inline Vd gather(double const* p, std::int64_t const* idx) { return _mm512_i64gather_pd(_mm512_loadu_si512(idx), p, 8); }
+
+inline Vd add(Vd a, Vd b) { return _mm512_add_pd(a, b); }
+inline Vd sub(Vd a, Vd b) { return _mm512_sub_pd(a, b); }
+inline Vd mul(Vd a, Vd b) { return _mm512_mul_pd(a, b); }
+inline Vd div(Vd a, Vd b) { return _mm512_div_pd(a, b); }
+/** a * b + c */
+inline Vd fmadd(Vd a, Vd b, Vd c) { return _mm512_fmadd_pd(a, b, c); }
+/** -(a * b) + c */
+inline Vd fnmadd(Vd a, Vd b, Vd c) { return _mm512_fnmadd_pd(a, b, c); }
+inline Vd min(Vd a, Vd b) { return _mm512_min_pd(a, b); }
+inline Vd max(Vd a, Vd b) { return _mm512_max_pd(a, b); }
+inline Vd sqrt(Vd a) { return _mm512_sqrt_pd(a); }
+inline Vd abs(Vd a) { return _mm512_abs_pd(a); }
+/** Round to the nearest integer */
+inline Vd round(Vd a) { return _mm512_roundscale_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+inline Md cmplt(Vd a, Vd b) { return _mm512_cmp_pd_mask(a, b, _CMP_LT_OQ); }
+inline Md cmple(Vd a, Vd b) { return _mm512_cmp_pd_mask(a, b, _CMP_LE_OQ); }
+inline Md cmpgt(Vd a, Vd b) { return _mm512_cmp_pd_mask(a, b, _CMP_GT_OQ); }
+inline Md cmpge(Vd a, Vd b) { return _mm512_cmp_pd_mask(a, b, _CMP_GE_OQ); }
+inline Md mand(Md a, Md b) { return a & b; }
+inline Md mor(Md a, Md b) { return a | b; }
+inline bool any(Md m) { return m != 0; }
+inline bool all(Md m) { return m == 0xFF; }
+/** Lane-wise m ? a : b */
+inline Vd select(Md m, Vd a, Vd b) { return _mm512_mask_blend_pd(m, b, a); }
+
+/** 2^n for integral n in [-1022, 1023] */
+inline Vd pow2n(Vd n)
+{
+  __m512i k = _mm512_cvtepi32_epi64(_mm512_cvtpd_epi32(n));
+  k = _mm512_slli_epi64(_mm512_add_epi64(k, _mm512_set1_epi64(1023)), 52);
+  return _mm512_castsi512_pd(k);
+}
+
+/** Unbiased exponent floor(log2(a)) of positive a */
+inline Vd getexp(Vd a) { return _mm512_getexp_pd(a); }
+/** Mantissa of positive a, in [1, 2) */
+inline Vd getmant(Vd a) { return _mm512_getmant_pd(a, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero); }
+
+#else // QF_SIMD_WIDTH == 4
+
+/** Register of doubles */
+using Vd = __m256d;
+/** Lane mask, the result of comparisons */
+using Md = __m256d;
+
+inline Vd load(double const* p) { return _mm256_loadu_pd(p); }
+inline void store(double* p, Vd a) { _mm256_storeu_pd(p, a); }
+inline Vd set1(double a) { return _mm256_set1_pd(a); }
+/** Lanes p[idx[0]], ..., p[idx[3]] */
+inline Vd gather(double const* p, std::int64_t const* idx)
+{
+  return _mm256_i64gather_pd(p, _mm256_loadu_si256(reinterpret_cast<__m256i const*>(idx)), 8);
+}
+
+inline Vd add(Vd a, Vd b) { return _mm256_add_pd(a, b); }
+inline Vd sub(Vd a, Vd b) { return _mm256_sub_pd(a, b); }
+inline Vd mul(Vd a, Vd b) { return _mm256_mul_pd(a, b); }
+inline Vd div(Vd a, Vd b) { return _mm256_div_pd(a, b); }
+/** a * b + c */
+inline Vd fmadd(Vd a, Vd b, Vd c) { return _mm256_fmadd_pd(a, b, c); }
+/** -(a * b) + c */
+inline Vd fnmadd(Vd a, Vd b, Vd c) { return _mm256_fnmadd_pd(a, b, c); }
+inline Vd min(Vd a, Vd b) { return _mm256_min_pd(a, b); }
+inline Vd max(Vd a, Vd b) { return _mm256_max_pd(a, b); }
+inline Vd sqrt(Vd a) { return _mm256_sqrt_pd(a); }
+inline Vd abs(Vd a) { return _mm256_andnot_pd(_mm256_set1_pd(-0.0), a); }
+/** Round to the nearest integer */
+inline Vd round(Vd a) { return _mm256_round_pd(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+
+inline Md cmplt(Vd a, Vd b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+inline Md cmple(Vd a, Vd b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+inline Md cmpgt(Vd a, Vd b) { return _mm256_cmp_pd(a, b, _CMP_GT_OQ); }
+inline Md cmpge(Vd a, Vd b) { return _mm256_cmp_pd(a, b, _CMP_GE_OQ); }
+inline Md mand(Md a, Md b) { return _mm256_and_pd(a, b); }
+inline Md mor(Md a, Md b) { return _mm256_or_pd(a, b); }
+inline bool any(Md m) { return _mm256_movemask_pd(m) != 0; }
+inline bool all(Md m) { return _mm256_movemask_pd(m) == 0xF; }
+/** Lane-wise m ? a : b */
+inline Vd select(Md m, Vd a, Vd b) { return _mm256_blendv_pd(b, a, m); }
+
+/** 2^n for integral n in [-1022, 1023] */
+inline Vd pow2n(Vd n)
+{
+  __m256i k = _mm256_cvtepi32_epi64(_mm256_cvtpd_epi32(n));
+  k = _mm256_slli_epi64(_mm256_add_epi64(k, _mm256_set1_epi64x(1023)), 52);
+  return _mm256_castsi256_pd(k);
+}
+
+/** Unbiased exponent floor(log2(a)) of positive normal a */
+inline Vd getexp(Vd a)
+{
+  // place the biased exponent in the mantissa of 2^52 and subtract 2^52 + 1023
+  __m256i e = _mm256_srli_epi64(_mm256_castpd_si256(a), 52);
+  e = _mm256_or_si256(e, _mm256_set1_epi64x(0x4330000000000000LL));
+  return _mm256_sub_pd(_mm256_castsi256_pd(e), _mm256_set1_pd(4503599627370496.0 + 1023.0));
+}
+/** Mantissa of positive normal a, in [1, 2) */
+inline Vd getmant(Vd a)
+{
+  __m256i m = _mm256_and_si256(_mm256_castpd_si256(a), _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL));
+  return _mm256_castsi256_pd(_mm256_or_si256(m, _mm256_set1_epi64x(0x3FF0000000000000LL)));
+}
+
+#endif // QF_SIMD_WIDTH
+
+///////////////////////////////////////////////////////////////////////////////
+// Elementary functions built on the primitives
+
+/** The exponential function e^x.
+    Cody-Waite reduction by ln(2) and a degree 13 Taylor polynomial on |r| <= ln(2)/2;
+    the maximum error against std::exp is 1 ulp. Underflows gradually to 0 below -708.
+*/
+inline Vd exp(Vd x)
+{
+  const double LOG2E = 1.4426950408889634;
+  const double LN2HI = 6.93147180369123816490e-01;
+  const double LN2LO = 1.90821492927058770002e-10;
+
+  // min and max return their second operand if either is NaN, so x comes second to propagate it
+  x = max(set1(-746.0), x);   // below this e^x is 0
+  x = min(set1(710.0), x);    // above this e^x is inf
+  Vd n = round(mul(x, set1(LOG2E)));
+  Vd r = fnmadd(n, set1(LN2HI), x);
+  r = fnmadd(n, set1(LN2LO), r);
+
+  // 1 + r + r^2/2! + ... + r^13/13!
+  Vd p = set1(1.0 / 6227020800.0);
+  p = fmadd(p, r, set1(1.0 / 479001600.0));
+  p = fmadd(p, r, set1(1.0 / 39916800.0));
+  p = fmadd(p, r, set1(1.0 / 3628800.0));
+  p = fmadd(p, r, set1(1.0 / 362880.0));
+  p = fmadd(p, r, set1(1.0 / 40320.0));
+  p = fmadd(p, r, set1(1.0 / 5040.0));
+  p = fmadd(p, r, set1(1.0 / 720.0));
+  p = fmadd(p, r, set1(1.0 / 120.0));
+  p = fmadd(p, r, set1(1.0 / 24.0));
+  p = fmadd(p, r, set1(1.0 / 6.0));
+  p = fmadd(p, r, set1(0.5));
+  p = fmadd(p, r, set1(1.0));
+  p = fmadd(p, r, set1(1.0));
+
+  // scale by 2^n in two steps, so that subnormal results and 2^1024 are reached correctly
+  Vd n1 = round(mul(n, set1(0.5)));
+  Vd n2 = sub(n, n1);
+  return mul(mul(p, pow2n(n1)), pow2n(n2));
+}
+
+/** The natural logarithm of positive normal x.
+    Reduction to a mantissa in [sqrt(2)/2, sqrt(2)) and the fdlibm polynomial;
+    the maximum relative error against std::log is 1 ulp.
+*/
+inline Vd log(Vd x)
+{
+  const double LN2HI = 6.93147180369123816490e-01;
+  const double LN2LO = 1.90821492927058770002e-10;
+  const double LG1 = 6.666666666666735130e-01;
+  const double LG2 = 3.999999999940941908e-01;
+  const double LG3 = 2.857142874366239149e-01;
+  const double LG4 = 2.222219843214978396e-01;
+  const double LG5 = 1.818357216161805012e-01;
+  const double LG6 = 1.531383769920937332e-01;
+  const double LG7 = 1.479819860511658591e-01;
+
+  Vd e = getexp(x);
+  Vd m = getmant(x);
+  Md big = cmpgt(m, set1(M_SQRT2));
+  m = select(big, mul(m, set1(0.5)), m);
+  e = select(big, add(e, set1(1.0)), e);
+
+  Vd f = sub(m, set1(1.0));
+  Vd hfsq = mul(set1(0.5), mul(f, f));
+  Vd s = div(f, add(set1(2.0), f));
+  Vd z = mul(s, s);
+  Vd w = mul(z, z);
+  Vd t1 = mul(w, fmadd(w, fmadd(w, set1(LG6), set1(LG4)), set1(LG2)));
+  Vd t2 = mul(z, fmadd(w, fmadd(w, fmadd(w, set1(LG7), set1(LG5)), set1(LG3)), set1(LG1)));
+  Vd r = add(t2, t1);
+  // e * ln2 + f - (hfsq - s * (hfsq + r))
+  Vd lo = fmadd(s, add(hfsq, r), mul(e, set1(LN2LO)));
+  return fmadd(e, set1(LN2HI), sub(f, sub(hfsq, lo)));
+}
+
+END_NAMESPACE(simd)
+END_NAMESPACE(qf)
+
+#endif // QF_SIMD_WIDTH > 1
+
+#endif // QF_SIMD_HPP
@@ -4,6 +4,7 @@
 */
 
 #include <qflib/math/stats/errorfunction.hpp>
+#include <qflib/math/simd.hpp>
 #include <cmath>
 using namespace std;
 
@@ -80,4 +81,59 @@ double ErrorFunction::inverfc(double p)
   return (p < 1.0 ? x : -x);
 }
 
+#if QF_SIMD_WIDTH > 1
+namespace {
+
+// Vector version of erfccheb(z) for non-negative z; cof are the Chebyshev coefficients
+inline simd::Vd erfcchebSimd(simd::Vd z, double const* cof, int ncof)
+{
+  using namespace simd;
+  Vd t = div(set1(2.0), add(set1(2.0), z));
+  Vd ty = fmadd(set1(4.0), t, set1(-2.0));
+  Vd d = set1(0.0), dd = set1(0.0);
+  for (int j = ncof - 1; j > 0; j--) {
+    Vd tmp = d;
+    d = sub(fmadd(ty, d, set1(cof[j])), dd);
+    dd = tmp;
+  }
+  // -z^2 + 0.5 * (cof[0] + ty * d) - dd
+  Vd arg = fmadd(set1(0.5), fmadd(ty, d, set1(cof[0])), fnmadd(z, z, set1(0.0)));
+  arg = sub(arg, dd);
+  return mul(t, simd::exp(arg));
+}
+
+} // anonymous namespace
+#endif
+
+void ErrorFunction::erf(size_t n, double const* x, double* y)
+{
+  size_t i = 0;
+#if QF_SIMD_WIDTH > 1
+  using namespace simd;
+  for (; i + QF_SIMD_WIDTH <= n; i += QF_SIMD_WIDTH) {
+    Vd xv = load(x + i);
+    Vd r = erfcchebSimd(abs(xv), cof, ncof);
+    store(y + i, select(cmpge(xv, set1(0.0)), sub(set1(1.0), r), sub(r, set1(1.0))));
+  }
+#endif
+  // NaN gives NaN, as in the SIMD loop, rather than failing the assertion of erfccheb
+  for (; i < n; ++i)
+    y[i] = std::isnan(x[i]) ? x[i] : erf(x[i]);
+}
+
+void ErrorFunction::erfc(size_t n, double const* x, double* y)
+{
+  size_t i = 0;
+#if QF_SIMD_WIDTH > 1
+  using namespace simd;
+  for (; i + QF_SIMD_WIDTH <= n; i += QF_SIMD_WIDTH) {
+    Vd xv = load(x + i);
+    Vd r = erfcchebSimd(abs(xv), cof, ncof);
+    store(y + i, select(cmpge(xv, set1(0.0)), r, sub(set1(2.0), r)));
+  }
+#endif
+  for (; i < n; ++i)
+    y[i] = std::isnan(x[i]) ? x[i] : erfc(x[i]);
+}
+
 END_NAMESPACE(qf)
@@ -30,6 +30,21 @@ public:
   /** Returns the inverse of the complement of the error function */
   static double inverfc(double p);
 
+  /** Computes erf(x[i]) for i in [0, n), writing the results to y[i].
+      The arrays x and y may be the same. With SIMD enabled (QF_SIMD_WIDTH > 1) 
+      the maximum absolute difference from erf(double) is 3e-16; otherwise the results are identical.
+      In every build a NaN element gives NaN, whereas erf(double) throws.
+  */
+  static void erf(size_t n, double const* x, double* y);
+
+  /** Computes erfc(x[i]) for i in [0, n), writing the results to y[i].
+      The arrays x and y may be the same. With SIMD enabled (QF_SIMD_WIDTH > 1) 
+      the maximum relative difference from erfc(double) is 1e-14 for |x| <= 5; beyond that it grows 
+      like x^2 * 1e-16 with the conditioning of exp(-x^2). Otherwise the results are identical.
+      In every build a NaN element gives NaN, whereas erfc(double) throws.
+  */
+  static void erfc(size_t n, double const* x, double* y);
+
 private:
   // This class is a namespace for error function related functions.
   // No default or copy construction or assignment allowed.
@@ -0,0 +1,187 @@
+/**
+@file  inversenormal.cpp
+@brief Implementation of the fast inverse of the standard normal cumulative distribution function
+*/
+
+#include <qflib/math/stats/inversenormal.hpp>
+#include <qflib/math/simd.hpp>
+#include <cmath>
+#include <limits>
+using namespace std;
+
+BEGIN_NAMESPACE(qf)
+
+namespace {
+
+/* Coefficients of Wichura's AS241 (PPND16), in increasing powers.
+   A/B: central region |p - 0.5| <= 0.425, C/D: intermediate tail r <= 5, E/F: far tail r > 5
+*/
+const double AS241_A[8] = {
+  3.3871328727963666080e0,  1.3314166789178437745e+2, 1.9715909503065514427e+3, 1.3731693765509461125e+4,
+  4.5921953931549871457e+4, 6.7265770927008700853e+4, 3.3430575583588128105e+4, 2.5090809287301226727e+3 };
+const double AS241_B[8] = {
+  1.0,                      4.2313330701600911252e+1, 6.8718700749205790830e+2, 5.3941960214247511077e+3,
+  2.1213794301586595867e+4, 3.9307895800092710610e+4, 2.8729085735721942674e+4, 5.2264952788528545610e+3 };
+const double AS241_C[8] = {
+  1.42343711074968357734e0, 4.63033784615654529590e0, 5.76949722146069140550e0, 3.64784832476320460504e0,
+  1.27045825245236838258e0, 2.41780725177450611770e-1, 2.27238449892691845833e-2, 7.74545014278341407640e-4 };
+const double AS241_D[8] = {
+  1.0,                      2.05319162663775882187e0, 1.67638483018380384940e0, 6.89767334985100004550e-1,
+  1.48103976427480074590e-1, 1.51986665636164571966e-2, 5.47593808499534494600e-4, 1.05075007164441684324e-9 };
+const double AS241_E[8] = {
+  6.65790464350110377720e0, 5.46378491116411436990e0, 1.78482653991729133580e0, 2.96560571828504891230e-1,
+  2.65321895265761230930e-2, 1.24266094738807843860e-3, 2.71155556874348757815e-5, 2.01033439929228813265e-7 };
+const double AS241_F[8] = {
+  1.0,                      5.99832206555887937690e-1, 1.36929880922735805310e-1, 1.48753612908506148525e-2,
+  7.86869131145613259100e-4, 1.84631831751005468180e-5, 1.42151175831644588870e-7, 2.04426310338993978564e-15 };
+
+/* Coefficients of Acklam's approximation, in increasing powers.
+   A/B: central region, C/D: tails p < 0.02425 or p > 0.97575
+*/
+const double ACKLAM_A[6] = {
+  2.506628277459239e+00, -3.066479806614716e+01, 1.383577518672690e+02,
+  -2.759285104469687e+02, 2.209460984245205e+02, -3.969683028665376e+01 };
+const double ACKLAM_B[6] = {
+  1.0, -1.328068155288572e+01, 6.680131188771972e+01,
+  -1.556989798598866e+02, 1.615858368580409e+02, -5.447609879822406e+01 };
+const double ACKLAM_C[6] = {
+  2.938163982698783e+00, 4.374664141464968e+00, -2.549732539343734e+00,
+  -2.400758277161838e+00, -3.223964580411365e-01, -7.784894002430293e-03 };
+const double ACKLAM_D[5] = {
+  1.0, 3.754408661907416e+00, 2.445134137142996e+00, 3.224671290700398e-01, 7.784695709041462e-03 };
+const double ACKLAM_PLOW = 0.02425;
+
+// Horner evaluation of c[0] + c[1] x + ... + c[n-1] x^(n-1)
+inline double polyval(double const* c, int n, double x)
+{
+  double val = c[n - 1];
+  for (int i = n - 2; i >= 0; --i)
+    val = val * x + c[i];
+  return val;
+}
+
+// Value returned for p outside (0, 1)
+inline double outOfRange(double p)
+{
+  if (p == 0.0)
+    return -numeric_limits<double>::infinity();
+  if (p == 1.0)
+    return numeric_limits<double>::infinity();
+  return numeric_limits<double>::quiet_NaN();
+}
+
+#if QF_SIMD_WIDTH > 1
+// Vector Horner evaluation of c[0] + c[1] x + ... + c[n-1] x^(n-1)
+inline simd::Vd polyval(double const* c, int n, simd::Vd x)
+{
+  simd::Vd val = simd::set1(c[n - 1]);
+  for (int i = n - 2; i >= 0; --i)
+    val = simd::fmadd(val, x, simd::set1(c[i]));
+  return val;
+}
+
+// AS241 on a register of p in [1e-300, 1)
+inline simd::Vd as241Simd(simd::Vd p)
+{
+  using namespace simd;
+  Vd q = sub(p, set1(0.5));
+  Md central = cmple(abs(q), set1(0.425));
+  Vd r = fnmadd(q, q, set1(0.180625));
+  Vd x = div(mul(q, polyval(AS241_A, 8, r)), polyval(AS241_B, 8, r));
+  if (all(central))
+    return x;
+
+  Md lower = cmplt(q, set1(0.0));
+  Vd t = sqrt(sub(set1(0.0), log(select(lower, p, sub(set1(1.0), p)))));
+  Vd tc = sub(t, set1(1.6));
+  Vd xt = div(polyval(AS241_C, 8, tc), polyval(AS241_D, 8, tc));
+  Md far = cmpgt(t, set1(5.0));
+  if (any(far)) {
+    Vd te = sub(t, set1(5.0));
+    xt = select(far, div(polyval(AS241_E, 8, te), polyval(AS241_F, 8, te)), xt);
+  }
+  xt = select(lower, sub(set1(0.0), xt), xt);
+  return select(central, x, xt);
+}
+
+// Acklam's approximation on a register of p in [1e-300, 1)
+inline simd::Vd acklamSimd(simd::Vd p)
+{
+  using namespace simd;
+  Vd q = sub(p, set1(0.5));
+  Md central = cmple(abs(q), set1(0.5 - ACKLAM_PLOW));
+  Vd r = mul(q, q);
+  Vd x = div(mul(q, polyval(ACKLAM_A, 6, r)), polyval(ACKLAM_B, 6, r));
+  if (all(central))
+    return x;
+
+  Md lower = cmplt(q, set1(0.0));
+  Vd t = sqrt(mul(set1(-2.0), log(select(lower, p, sub(set1(1.0), p)))));
+  Vd xt = div(polyval(ACKLAM_C, 6, t), polyval(ACKLAM_D, 5, t));
+  xt = select(lower, xt, sub(set1(0.0), xt));
+  return select(central, x, xt);
+}
+#endif
+
+} // anonymous namespace
+
+double InverseNormal::as241(double p)
+{
+  if (!(p > 0.0 && p < 1.0))
+    return outOfRange(p);
+
+  double q = p - 0.5;
+  if (abs(q) <= 0.425) {
+    double r = 0.180625 - q * q;
+    return q * polyval(AS241_A, 8, r) / polyval(AS241_B, 8, r);
+  }
+  double r = sqrt(-log(q < 0.0 ? p : 1.0 - p));
+  double x;
+  if (r <= 5.0) {
+    r -= 1.6;
+    x = polyval(AS241_C, 8, r) / polyval(AS241_D, 8, r);
+  }
+  else {
+    r -= 5.0;
+    x = polyval(AS241_E, 8, r) / polyval(AS241_F, 8, r);
+  }
+  return q < 0.0 ? -x : x;
+}
+
+double InverseNormal::acklam(double p)
+{
+  if (!(p > 0.0 && p < 1.0))
+    return outOfRange(p);
+
+  double q = p - 0.5;
+  if (abs(q) <= 0.5 - ACKLAM_PLOW) {
+    double r = q * q;
+    return q * polyval(ACKLAM_A, 6, r) / polyval(ACKLAM_B, 6, r);
+  }
+  double t = sqrt(-2.0 * log(q < 0.0 ? p : 1.0 - p));
+  double x = polyval(ACKLAM_C, 6, t) / polyval(ACKLAM_D, 5, t);
+  return q < 0.0 ? x : -x;
+}
+
+void InverseNormal::invcdf(size_t n, double const* p, double* x, Precision prec)
+{
+  size_t i = 0;
+#if QF_SIMD_WIDTH > 1
+  using namespace simd;
+  bool full = prec == Precision::FULL;
+  for (; i + QF_SIMD_WIDTH <= n; i += QF_SIMD_WIDTH) {
+    Vd pv = load(p + i);
+    // out of range, NaN and subnormal probabilities go through the scalar functions
+    if (!all(mand(cmpge(pv, set1(1e-300)), cmplt(pv, set1(1.0))))) {
+      for (size_t j = i; j < i + QF_SIMD_WIDTH; ++j)
+        x[j] = invcdf(p[j], prec);
+      continue;
+    }
+    store(x + i, full ? as241Simd(pv) : acklamSimd(pv));
+  }
+#endif
+  for (; i < n; ++i)
+    x[i] = invcdf(p[i], prec);
+}
+
+END_NAMESPACE(qf)
@@ -0,0 +1,56 @@
+/**
+@file  inversenormal.hpp
+@brief Fast inverse of the standard normal cumulative distribution function
+*/
+
+#ifndef QF_INVERSENORMAL_HPP
+#define QF_INVERSENORMAL_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+
+BEGIN_NAMESPACE(qf)
+
+/** Class containing high-throughput approximations of the inverse standard normal cdf.
+    The functions are static members, no objects of class InverseNormal can be created.
+    For p outside (0, 1) they return -inf at 0, +inf at 1 and NaN otherwise; they do not throw.
+*/
+class InverseNormal
+{
+public:
+  /** Accuracy of the approximation */
+  enum class Precision
+  {
+    FULL,   // Wichura's AS241 (PPND16), relative error about 1e-16
+    FAST    // Acklam's rational approximation, relative error below 1.15e-9
+  };
+
+  /** Wichura's algorithm AS241 (PPND16), Applied Statistics 37 (1988) */
+  static double as241(double p);
+
+  /** Acklam's rational approximation with one region split at p = 0.02425 */
+  static double acklam(double p);
+
+  /** Returns x such that N(x) = p, with N the standard normal cdf */
+  static double invcdf(double p, Precision prec = Precision::FULL)
+  {
+    return prec == Precision::FULL ? as241(p) : acklam(p);
+  }
+
+  /** Computes x[i] such that N(x[i]) = p[i] for i in [0, n). The arrays p and x may be the same.
+      With SIMD enabled (QF_SIMD_WIDTH > 1) the maximum relative difference from the scalar
+      functions is 1e-15; otherwise the results are identical.
+  */
+  static void invcdf(size_t n, double const* p, double* x, Precision prec = Precision::FULL);
+
+private:
+  // This class is a namespace for inverse normal functions.
+  // No default or copy construction or assignment allowed.
+  InverseNormal() = delete;
+  InverseNormal(InverseNormal const&) = delete;
+  InverseNormal& operator=(InverseNormal const&) = delete;
+};
+
+END_NAMESPACE(qf)
+
+#endif // QF_INVERSENORMAL_HPP
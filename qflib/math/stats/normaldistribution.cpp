@@ -0,0 +1,50 @@
+/**
+@file  normaldistribution.cpp
+@brief Implementation of the array functions of the normal distribution
+*/
+
+#include <qflib/math/stats/normaldistribution.hpp>
+#include <qflib/math/simd.hpp>
+#include <cmath>
+#include <string>
+
+BEGIN_NAMESPACE(qf)
+
+void NormalDistribution::pdf(size_t n, double const* x, double* y) const
+{
+  size_t i = 0;
+#if QF_SIMD_WIDTH > 1
+  double c = M_1_SQRT2PI / sig_;
+  for (; i + QF_SIMD_WIDTH <= n; i += QF_SIMD_WIDTH) {
+    simd::Vd z = simd::div(simd::sub(simd::load(x + i), simd::set1(mu_)), simd::set1(sig_));
+    simd::Vd e = simd::exp(simd::mul(simd::set1(-0.5), simd::mul(z, z)));
+    simd::store(y + i, simd::mul(simd::set1(c), e));
+  }
+#endif
+  for (; i < n; ++i)
+    y[i] = pdf(x[i]);
+}
+
+void NormalDistribution::cdf(size_t n, double const* x, double* y) const
+{
+  // same operations as the scalar cdf(), with the erfc evaluated on the whole array
+  for (size_t i = 0; i < n; ++i)
+    y[i] = -M_SQRT1_2 * (x[i] - mu_) / sig_;
+  ErrorFunction::erfc(n, y, y);
+  for (size_t i = 0; i < n; ++i)
+    y[i] *= 0.5;
+}
+
+void NormalDistribution::invcdf(size_t n, double const* p, double* x, InverseNormal::Precision prec) const
+{
+  for (size_t i = 0; i < n; ++i)
+    QF_ASSERT(p[i] > 0 && p[i] < 1, "error: prob. must be in (0,1); element " + std::to_string(i));
+
+  InverseNormal::invcdf(n, p, x, prec);
+  if (mu_ != 0.0 || sig_ != 1.0) {
+    for (size_t i = 0; i < n; ++i)
+      x[i] = sig_ * x[i] + mu_;
+  }
+}
+
+END_NAMESPACE(qf)
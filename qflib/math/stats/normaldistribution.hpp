@@ -10,9 +10,16 @@
 #include <qflib/exception.hpp>
 #include <qflib/math/stats/univariatedistribution.hpp>
 #include <qflib/math/stats/errorfunction.hpp>
+#include <qflib/math/stats/inversenormal.hpp>
 
 BEGIN_NAMESPACE(qf)
 
+/** The standard normal cumulative distribution function; the same as NormalDistribution().cdf(x) */
+inline double normalCdf(double x)
+{
+  return 0.5 * ErrorFunction::erfc(-M_SQRT1_2 * x);
+}
+
 /** The normal distribution */
 class NormalDistribution : public UnivariateDistribution
 {
@@ -43,6 +50,21 @@ public:
     return -M_SQRT2 * sig_ * ErrorFunction::inverfc(2.0 * p) + mu_;
   }
 
+  /** Probability density function at each x[i], i in [0, n), written to y[i]; x and y may be the same */
+  void pdf(size_t n, double const* x, double* y) const;
+
+  /** Cumulative distribution function at each x[i], i in [0, n), written to y[i]; x and y may be the same.
+      A NaN element gives NaN, as in the array erfc.
+  */
+  void cdf(size_t n, double const* x, double* y) const;
+
+  /** Inverse cumulative distribution function at each p[i], i in [0, n), written to x[i]; p and x may be the same.
+      It uses the InverseNormal approximations of the given precision, not the scalar invcdf().
+      All probabilities are validated before any value is computed.
+  */
+  void invcdf(size_t n, double const* p, double* x,
+              InverseNormal::Precision prec = InverseNormal::Precision::FULL) const;
+
 protected:
   double mu_, sig_;
 };
@@ -0,0 +1,202 @@
+/**
+@file  latticeengine.cpp
+@brief Implementation of lattice pricing of European, American and Bermudan options
+*/
+
+#include <qflib/methods/lattice/latticeengine.hpp>
+#include <qflib/pricers/simplepricers.hpp>
+#include <qflib/threadpool.hpp>
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+BEGIN_NAMESPACE(qf)
+
+namespace {
+
+// Number of options sharing the value buffer of one backward induction
+const size_t LATTICE_BLOCK_OPTS = 8;
+// Stretch parameter of the Kamrad-Ritchken trinomial lattice; the middle probability is 1/3
+const double KR_LAMBDA = 1.2247448713915890491;
+
+// Time steps, node prices and discounted transition probabilities of a lattice
+struct Lattice
+{
+  size_t nSteps;
+  bool trinomial;
+  double dt;
+  double lastRate;                 // the rate over the last time step
+  std::vector<double> pu, pm, pd;  // probabilities of each step times its discount factor
+  std::vector<double> nodePrice;   // spot * u^k, for k in [-nSteps, nSteps]
+  std::vector<char> exercisable;   // whether exercise is allowed at each time step, 0 to nSteps
+
+  // number of nodes at time step i
+  size_t nodes(size_t i) const { return trinomial ? 2 * i + 1 : i + 1; }
+  // asset price at node j of time step i
+  double price(size_t i, size_t j) const { return nodePrice[nSteps + (trinomial ? j : 2 * j) - i]; }
+};
+
+Lattice makeLattice(size_t n, LatticeType type, double spot, double timeToExp, double divYield,
+                    double volatility, YieldCurve const& yc, ExerciseType exercise, Vector const& exerciseTimes)
+{
+  Lattice lat;
+  lat.nSteps = n;
+  lat.trinomial = type == LatticeType::TRINOMIAL;
+  lat.dt = timeToExp / n;
+  double sqdt = sqrt(lat.dt);
+  double dx = (lat.trinomial ? KR_LAMBDA : 1.0) * volatility * sqdt;
+
+  lat.nodePrice.resize(2 * n + 1);
+  for (size_t k = 0; k <= 2 * n; ++k)
+    lat.nodePrice[k] = spot * exp((double(k) - double(n)) * dx);
+
+  lat.pu.resize(n);
+  lat.pm.assign(n, 0.0);
+  lat.pd.resize(n);
+  double u = exp(dx), d = 1.0 / u;
+  for (size_t i = 0; i < n; ++i) {
+    double t1 = i * lat.dt, t2 = i + 1 == n ? timeToExp : (i + 1) * lat.dt;
+    double disc = yc.fwdDiscount(t1, t2);
+    double rate = -log(disc) / (t2 - t1);
+    if (!lat.trinomial) {
+      double p = (exp(-divYield * lat.dt) / disc - d) / (u - d);
+      QF_ASSERT(p > 0.0 && p < 1.0, "too few lattice steps for the rates and volatility");
+      lat.pu[i] = disc * p;
+      lat.pd[i] = disc * (1.0 - p);
+    }
+    else {
+      double a = 0.5 / (KR_LAMBDA * KR_LAMBDA);
+      double b = (rate - divYield - 0.5 * volatility * volatility) * sqdt / (2.0 * KR_LAMBDA * volatility);
+      QF_ASSERT(a > fabs(b), "too few lattice steps for the rates and volatility");
+      lat.pu[i] = disc * (a + b);
+      lat.pm[i] = disc * (1.0 - 2.0 * a);
+      lat.pd[i] = disc * (a - b);
+    }
+    lat.lastRate = rate;
+  }
+
+  lat.exercisable.assign(n + 1, exercise == ExerciseType::AMERICAN);
+  if (exercise == ExerciseType::BERMUDAN) {
+    for (size_t k = 0; k < exerciseTimes.n_elem; ++k)
+      lat.exercisable[static_cast<size_t>(std::lround(exerciseTimes[k] / lat.dt))] = 1;
+  }
+  return lat;
+}
+
+// Prices the nb options of one block on the lattice, using v as the value buffer,
+// with the values of node j for option o in v[j * nb + o]
+void priceBlock(Lattice const& lat, size_t nb, double const* phi, double const* strike, bool smoothing,
+                double divYield, double volatility, std::vector<double>& v, double* price)
+{
+  size_t n = lat.nSteps;
+  size_t last = smoothing ? n - 1 : n;
+  v.resize(lat.nodes(last) * nb);
+
+  // values at the last time step: payoffs, or Black-Scholes prices over the last step
+  for (size_t j = 0; j < lat.nodes(last); ++j) {
+    double s = lat.price(last, j);
+    double* vj = &v[j * nb];
+    for (size_t o = 0; o < nb; ++o) {
+      double intrinsic = std::max(phi[o] * (s - strike[o]), 0.0);
+      if (!smoothing)
+        vj[o] = intrinsic;
+      else {
+        vj[o] = europeanOptionBS(int(phi[o]), s, strike[o], lat.dt, lat.lastRate, divYield, volatility);
+        if (lat.exercisable[last])
+          vj[o] = std::max(vj[o], intrinsic);
+      }
+    }
+  }
+
+  // backward induction in place: node j of step i only reads nodes j to j + 2 of step i + 1
+  for (size_t i = last; i-- > 0; ) {
+    double pu = lat.pu[i], pm = lat.pm[i], pd = lat.pd[i];
+    size_t w = lat.nodes(i);
+    if (lat.trinomial) {
+      for (size_t j = 0; j < w; ++j) {
+        double* vj = &v[j * nb];
+        for (size_t o = 0; o < nb; ++o)
+          vj[o] = pd * vj[o] + pm * vj[o + nb] + pu * vj[o + 2 * nb];
+      }
+    }
+    else {
+      for (size_t j = 0; j < w; ++j) {
+        double* vj = &v[j * nb];
+        for (size_t o = 0; o < nb; ++o)
+          vj[o] = pd * vj[o] + pu * vj[o + nb];
+      }
+    }
+    if (lat.exercisable[i]) {
+      for (size_t j = 0; j < w; ++j) {
+        double s = lat.price(i, j);
+        double* vj = &v[j * nb];
+        for (size_t o = 0; o < nb; ++o)
+          vj[o] = std::max(vj[o], phi[o] * (s - strike[o]));
+      }
+    }
+  }
+
+  std::copy(v.begin(), v.begin() + nb, price);
+}
+
+} // anonymous namespace
+
+/** Prices of a batch of vanilla options with the same expiration on a recombining lattice */
+void latticeGBM(size_t nOpts, int const* payoffType, double const* strike, double spot, double timeToExp,
+                double divYield, double volatility, SPtrYieldCurve const& spyc, ExerciseType exercise,
+                Vector const& exerciseTimes, double* price, LatticeParams const& params)
+{
+  QF_ASSERT(spot > 0.0, "spot must be positive");
+  QF_ASSERT(timeToExp > 0.0, "time to expiration must be positive");
+  QF_ASSERT(divYield >= 0.0, "dividend yield must be non-negative");
+  QF_ASSERT(volatility > 0.0, "volatility must be positive");
+  QF_ASSERT(spyc, "yield curve must not be null");
+  QF_ASSERT(params.nSteps >= (params.richardson ? 4 : 2), "too few lattice steps");
+  for (size_t i = 0; i < nOpts; ++i) {
+    QF_ASSERT(payoffType[i] == 1 || payoffType[i] == -1, "payoffType must be 1 or -1");
+    QF_ASSERT(strike[i] >= 0.0, "strike must be non-negative");
+  }
+  if (exercise == ExerciseType::BERMUDAN) {
+    for (size_t k = 0; k < exerciseTimes.n_elem; ++k)
+      QF_ASSERT(exerciseTimes[k] >= 0.0 && exerciseTimes[k] <= timeToExp,
+                "exercise times must be between 0 and the time to expiration");
+  }
+  if (nOpts == 0)
+    return;
+
+  std::vector<double> phi(payoffType, payoffType + nOpts);
+  Lattice lat = makeLattice(params.nSteps, params.type, spot, timeToExp, divYield, volatility,
+                            *spyc, exercise, exerciseTimes);
+  Lattice half;
+  if (params.richardson)
+    half = makeLattice(params.nSteps / 2, params.type, spot, timeToExp, divYield, volatility,
+                       *spyc, exercise, exerciseTimes);
+
+  size_t nBlocks = (nOpts + LATTICE_BLOCK_OPTS - 1) / LATTICE_BLOCK_OPTS;
+  threadPool().parallelFor(nBlocks, [&](size_t ib) {
+    size_t first = ib * LATTICE_BLOCK_OPTS;
+    size_t nb = std::min(LATTICE_BLOCK_OPTS, nOpts - first);
+    std::vector<double> v;
+    priceBlock(lat, nb, &phi[first], strike + first, params.smoothing, divYield, volatility, v, price + first);
+    if (params.richardson) {
+      double coarse[LATTICE_BLOCK_OPTS];
+      priceBlock(half, nb, &phi[first], strike + first, params.smoothing, divYield, volatility, v, coarse);
+      for (size_t o = 0; o < nb; ++o)
+        price[first + o] = 2.0 * price[first + o] - coarse[o];
+    }
+  });
+}
+
+/** Price of a vanilla option on a recombining lattice */
+double latticeGBM(int payoffType, double spot, double strike, double timeToExp, double divYield,
+                  double volatility, SPtrYieldCurve const& spyc, ExerciseType exercise,
+                  Vector const& exerciseTimes, LatticeParams const& params)
+{
+  double price;
+  latticeGBM(1, &payoffType, &strike, spot, timeToExp, divYield, volatility, spyc, exercise,
+             exerciseTimes, &price, params);
+  return price;
+}
+
+END_NAMESPACE(qf)
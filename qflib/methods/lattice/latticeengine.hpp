@@ -0,0 +1,64 @@
+/**
+@file  latticeengine.hpp
+@brief Lattice pricing of European, American and Bermudan options
+*/
+
+#ifndef QF_LATTICEENGINE_HPP
+#define QF_LATTICEENGINE_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <qflib/math/matrix.hpp>
+#include <qflib/market/yieldcurve.hpp>
+
+BEGIN_NAMESPACE(qf)
+
+/** The lattice geometry */
+enum class LatticeType
+{
+  BINOMIAL,   // Cox-Ross-Rubinstein
+  TRINOMIAL   // Kamrad-Ritchken, with stretch parameter sqrt(3/2)
+};
+
+/** The exercise style of an option */
+enum class ExerciseType
+{
+  EUROPEAN,   // at expiration only
+  AMERICAN,   // at every time step
+  BERMUDAN    // at the time steps nearest to the exercise times, and at expiration
+};
+
+/** Lattice parameters */
+struct LatticeParams
+{
+  size_t nSteps = 500;                       // number of time steps
+  LatticeType type = LatticeType::BINOMIAL;  // lattice geometry
+  bool smoothing = false;     // if true, the values one step before expiration are Black-Scholes prices
+  bool richardson = false;    // if true, extrapolates 2 V(nSteps) - V(nSteps / 2)
+};
+
+/** Prices of a batch of vanilla options with the same expiration on a recombining lattice for the
+    geometric Brownian motion, with the rates of a yield curve.
+    The up and down moves are fixed by the volatility; the probabilities of every step match the
+    forward rate of the yield curve over the step, and are precomputed together with the step
+    discount factors.
+    All options share one lattice: the values of a block of options are kept node after node in a
+    single buffer updated in place by the backward induction, with no allocation per step.
+    The blocks are priced in parallel on threadPool().
+    Smoothing (Broadie and Detemple, 1996) removes most of the oscillation of the price with the
+    number of steps, after which Richardson extrapolation is most effective.
+    exerciseTimes are only used for Bermudan exercise.
+    The prices are written to price[0, nOpts).
+*/
+void latticeGBM(size_t nOpts, int const* payoffType, double const* strike, double spot, double timeToExp,
+                double divYield, double volatility, SPtrYieldCurve const& spyc, ExerciseType exercise,
+                Vector const& exerciseTimes, double* price, LatticeParams const& params = LatticeParams());
+
+/** Price of a vanilla option on a recombining lattice; see the batch version */
+double latticeGBM(int payoffType, double spot, double strike, double timeToExp, double divYield,
+                  double volatility, SPtrYieldCurve const& spyc, ExerciseType exercise,
+                  Vector const& exerciseTimes = Vector(), LatticeParams const& params = LatticeParams());
+
+END_NAMESPACE(qf)
+
+#endif // QF_LATTICEENGINE_HPP
@@ -0,0 +1,159 @@
+/**
+@file  mcengine.cpp
+@brief Implementation of multithreaded Monte Carlo pricing of path-dependent payoffs
+*/
+
+#include <qflib/methods/montecarlo/mcengine.hpp>
+#include <qflib/math/random/philox.hpp>
+#include <qflib/math/random/sobol.hpp>
+#include <qflib/math/random/brownianbridge.hpp>
+#include <qflib/math/stats/normaldistribution.hpp>
+#include <qflib/threadpool.hpp>
+
+#include <cmath>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <memory>
+
+BEGIN_NAMESPACE(qf)
+
+namespace {
+
+// Number of paths simulated per block; each block has its own random stream
+const size_t MC_BLOCK_PATHS = 1024;
+// Number of normal deviates converted per call of the array inverse normal cdf
+const size_t MC_CHUNK_NORMALS = 4096;
+
+// Sum and sum of squares of the payoffs of one block
+struct BlockSums
+{
+  double sum;
+  double sum2;
+};
+
+} // anonymous namespace
+
+/** Prices a path-dependent payoff by Monte Carlo simulation of the geometric Brownian motion */
+McResult mcGBM(double spot, double divYield, double volatility, SPtrYieldCurve const& spyc,
+               Vector const& fixTimes, PathPayoff const& payoff, McParams const& params)
+{
+  auto start = std::chrono::steady_clock::now();
+
+  QF_ASSERT(spot > 0.0, "spot must be positive");
+  QF_ASSERT(divYield >= 0.0, "dividend yield must be non-negative");
+  QF_ASSERT(volatility >= 0.0, "volatility must be non-negative");
+  QF_ASSERT(spyc, "yield curve must not be null");
+  QF_ASSERT(fixTimes.n_elem > 0, "at least one fixing time is required");
+  QF_ASSERT(params.nPaths > 1, "the number of paths must be greater than 1");
+  QF_ASSERT(!params.antithetic || (params.nPaths % 2 == 0 && params.nPaths > 2),
+            "the number of antithetic paths must be even and greater than 2");
+  for (size_t i = 0; i < fixTimes.n_elem; ++i)
+    QF_ASSERT(fixTimes[i] > (i == 0 ? 0.0 : fixTimes[i - 1]), "fixing times must be positive and increasing");
+
+  // log-price drifts and diffusion coefficients of each time step
+  size_t nSteps = fixTimes.n_elem;
+  std::vector<double> drift(nSteps), diffusion(nSteps), sqrtDt(nSteps);
+  double tprev = 0.0;
+  for (size_t i = 0; i < nSteps; ++i) {
+    double dt = fixTimes[i] - tprev;
+    drift[i] = -log(spyc->fwdDiscount(tprev, fixTimes[i])) - (divYield + 0.5 * volatility * volatility) * dt;
+    sqrtDt[i] = sqrt(dt);
+    diffusion[i] = volatility * sqrtDt[i];
+    tprev = fixTimes[i];
+  }
+  double logSpot = log(spot);
+
+  size_t nBlocks = (params.nPaths + MC_BLOCK_PATHS - 1) / MC_BLOCK_PATHS;
+  size_t chunkPaths = std::max<size_t>(1, MC_CHUNK_NORMALS / nSteps);
+  if (params.antithetic)
+    chunkPaths += chunkPaths % 2;
+  std::vector<BlockSums> sums(nBlocks);
+
+  // quasi-random paths: one Sobol dimension per time step, in Brownian bridge order
+  std::unique_ptr<SobolSequence> sobol;
+  std::unique_ptr<BrownianBridge> bridge;
+  if (params.quasiRandom) {
+    QF_ASSERT(nSteps <= SobolSequence::MAX_DEFAULT_DIMENSION, "too many fixing times for quasi-random paths");
+    QF_ASSERT(params.nPaths <= (size_t(1) << 32), "too many quasi-random paths");
+    sobol = std::make_unique<SobolSequence>(nSteps, SobolSequence::Scrambling::OWEN, params.seed);
+    bridge = std::make_unique<BrownianBridge>(fixTimes);
+  }
+
+  auto simulateBlock = [&](size_t ib) {
+    Philox4x32 rng(params.seed, ib);
+    std::vector<double> z(chunkPaths * nSteps), path(nSteps);
+    size_t first = ib * MC_BLOCK_PATHS;
+    size_t nb = std::min(MC_BLOCK_PATHS, params.nPaths - first);
+    std::unique_ptr<SobolSequence> seq;
+    if (sobol) {   // every block takes its own range of points
+      seq = std::make_unique<SobolSequence>(*sobol);
+      seq->skipTo(params.antithetic ? first / 2 : first);
+    }
+    double sum = 0.0, sum2 = 0.0, vprev = 0.0;
+    for (size_t ic = 0; ic < nb; ic += chunkPaths) {
+      size_t nc = std::min(chunkPaths, nb - ic);
+      size_t nz = params.antithetic ? (nc / 2) * nSteps : nc * nSteps;
+      if (seq) {
+        NormalDistribution normal;
+        seq->next(nz / nSteps, z.data());
+        normal.invcdf(nz, z.data(), z.data());
+        for (size_t k = 0; k < nz; k += nSteps) {   // bridge values to normalized increments
+          bridge->buildPath(z.data() + k, path.data());
+          for (size_t j = 0; j < nSteps; ++j)
+            z[k + j] = (path[j] - (j == 0 ? 0.0 : path[j - 1])) / sqrtDt[j];
+        }
+      }
+      else {
+        rng.normals(nz, z.data());
+      }
+      if (params.antithetic) {   // pairs of paths with opposite normals
+        for (size_t k = nz; k-- > 0; ) {
+          size_t p = k / nSteps, j = k % nSteps;
+          z[(2 * p + 1) * nSteps + j] = -z[k];
+          z[2 * p * nSteps + j] = z[k];
+        }
+      }
+      for (size_t p = 0; p < nc; ++p) {
+        double const* zp = z.data() + p * nSteps;
+        double x = logSpot;
+        for (size_t j = 0; j < nSteps; ++j) {
+          x += drift[j] + diffusion[j] * zp[j];
+          path[j] = exp(x);
+        }
+        double v = payoff(path.data(), nSteps);
+        if (params.antithetic) {   // one sample per pair
+          if (p % 2 == 0) {
+            vprev = v;
+            continue;
+          }
+          v = 0.5 * (v + vprev);
+        }
+        sum += v;
+        sum2 += v * v;
+      }
+    }
+    sums[ib] = BlockSums{sum, sum2};
+  };
+  threadPool().parallelFor(nBlocks, simulateBlock);
+
+  // reduce in block order
+  double sum = 0.0, sum2 = 0.0;
+  for (auto const& s : sums) {
+    sum += s.sum;
+    sum2 += s.sum2;
+  }
+  double n = static_cast<double>(params.antithetic ? params.nPaths / 2 : params.nPaths);
+  double mean = sum / n;
+  double var = std::max(sum2 / n - mean * mean, 0.0) * n / (n - 1.0);
+  double df = spyc->discount(fixTimes[nSteps - 1]);
+
+  McResult res;
+  res.price = df * mean;
+  res.stdErr = df * sqrt(var / n);
+  res.nPaths = params.nPaths;
+  res.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  return res;
+}
+
+END_NAMESPACE(qf)
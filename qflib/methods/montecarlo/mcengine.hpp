@@ -0,0 +1,51 @@
+/**
+@file  mcengine.hpp
+@brief Multithreaded Monte Carlo pricing of path-dependent payoffs
+*/
+
+#ifndef QF_MCENGINE_HPP
+#define QF_MCENGINE_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <qflib/math/matrix.hpp>
+#include <qflib/market/yieldcurve.hpp>
+#include <qflib/methods/montecarlo/pathpayoffs.hpp>
+
+BEGIN_NAMESPACE(qf)
+
+/** Monte Carlo simulation parameters */
+struct McParams
+{
+  size_t nPaths = 100000;     // number of simulated paths
+  unsigned long seed = 42;    // seed of the random streams
+  bool antithetic = false;    // if true, every second path uses the negated normals of the previous one
+  bool quasiRandom = false;   // if true, paths are built from an Owen-scrambled Sobol sequence by Brownian bridge
+};
+
+/** Monte Carlo simulation results */
+struct McResult
+{
+  double price;     // discounted mean payoff
+  double stdErr;    // standard error of the price
+  size_t nPaths;    // number of simulated paths
+  double time;      // wall clock time in seconds
+};
+
+/** Prices a path-dependent payoff by Monte Carlo simulation of the geometric Brownian motion
+    dS/S = (r(t) - q) dt + vol dW, with r(t) the forward rates of the yield curve.
+    The asset price is simulated at the fixing times, which must be positive and increasing,
+    and the payoff is discounted from the last fixing time.
+    Paths are simulated in blocks of fixed size distributed over the threads of threadPool();
+    every block draws from its own Philox4x32 stream, with the seed as key and the block index as
+    stream id, and the block sums are added in block order, so the results do not depend on the
+    number of threads.
+    With quasi-random paths every block takes its own range of points of one Sobol sequence;
+    the standard error is then the sample one, which overstates the error of the estimate.
+*/
+McResult mcGBM(double spot, double divYield, double volatility, SPtrYieldCurve const& spyc,
+               Vector const& fixTimes, PathPayoff const& payoff, McParams const& params);
+
+END_NAMESPACE(qf)
+
+#endif // QF_MCENGINE_HPP
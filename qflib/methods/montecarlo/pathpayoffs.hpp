@@ -0,0 +1,100 @@
+/**
+@file  pathpayoffs.hpp
+@brief Payoff functors evaluated on simulated asset price paths
+*/
+
+#ifndef QF_PATHPAYOFFS_HPP
+#define QF_PATHPAYOFFS_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <algorithm>
+#include <memory>
+
+BEGIN_NAMESPACE(qf)
+
+/** Abstract base class of payoffs on a path of asset prices.
+    The path holds the asset prices at the fixing times; the payoff is paid at the last fixing time.
+    Implementations must be thread safe, as paths are evaluated concurrently.
+*/
+class PathPayoff
+{
+public:
+  /** Returns the payoff of the path of nFixings prices */
+  virtual double operator()(double const* path, size_t nFixings) const = 0;
+
+  /** dtor */
+  virtual ~PathPayoff() {}
+};
+
+using SPtrPathPayoff = std::shared_ptr<PathPayoff>;
+
+/** European option on the price at the last fixing */
+class EuropeanPayoff : public PathPayoff
+{
+public:
+  EuropeanPayoff(int payoffType, double strike)
+  : phi_(payoffType), strike_(strike)
+  {
+    QF_ASSERT(payoffType == 1 || payoffType == -1, "payoffType must be 1 or -1");
+    QF_ASSERT(strike >= 0.0, "strike must be non-negative");
+  }
+
+  virtual double operator()(double const* path, size_t nFixings) const override
+  {
+    return std::max(phi_ * (path[nFixings - 1] - strike_), 0.0);
+  }
+
+private:
+  double phi_;
+  double strike_;
+};
+
+/** European digital option on the price at the last fixing, paying 1 */
+class DigitalPayoff : public PathPayoff
+{
+public:
+  DigitalPayoff(int payoffType, double strike)
+  : phi_(payoffType), strike_(strike)
+  {
+    QF_ASSERT(payoffType == 1 || payoffType == -1, "payoffType must be 1 or -1");
+    QF_ASSERT(strike >= 0.0, "strike must be non-negative");
+  }
+
+  virtual double operator()(double const* path, size_t nFixings) const override
+  {
+    return phi_ * (path[nFixings - 1] - strike_) > 0.0 ? 1.0 : 0.0;
+  }
+
+private:
+  double phi_;
+  double strike_;
+};
+
+/** Asian option on the arithmetic average of the prices at all fixings */
+class AsianPayoff : public PathPayoff
+{
+public:
+  AsianPayoff(int payoffType, double strike)
+  : phi_(payoffType), strike_(strike)
+  {
+    QF_ASSERT(payoffType == 1 || payoffType == -1, "payoffType must be 1 or -1");
+    QF_ASSERT(strike >= 0.0, "strike must be non-negative");
+  }
+
+  virtual double operator()(double const* path, size_t nFixings) const override
+  {
+    double sum = 0.0;
+    for (size_t i = 0; i < nFixings; ++i)
+      sum += path[i];
+    return std::max(phi_ * (sum / nFixings - strike_), 0.0);
+  }
+
+private:
+  double phi_;
+  double strike_;
+};
+
+END_NAMESPACE(qf)
+
+#endif // QF_PATHPAYOFFS_HPP
@@ -0,0 +1,253 @@
+/**
+@file  fdengine.cpp
+@brief Implementation of finite difference pricing of European and American options
+*/
+
+#include <qflib/methods/pde/fdengine.hpp>
+#include <qflib/math/linalg/tridiagonal.hpp>
+#include <qflib/threadpool.hpp>
+
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+BEGIN_NAMESPACE(qf)
+
+namespace {
+
+// Penalty factor enforcing the early exercise constraint; the constraint is violated by O(1/FD_PENALTY)
+const double FD_PENALTY = 1.0e8;
+// Maximum number of penalty iterations per time step
+const size_t FD_MAX_PENALTY_ITER = 100;
+// Relative change of the rate below which the factored system of the previous step is reused
+const double FD_RATE_TOL = 1.0e-12;
+
+// Grid of moneyness m = S/K and coefficients of the discrete operators at each node,
+// so that (0.5 vol^2 m^2 d2v/dm2)_i = diffL v_{i-1} + diffD v_i + diffU v_{i+1}
+// and (m dv/dm)_i = convL v_{i-1} + convD v_i + convU v_{i+1}
+struct FdGrid
+{
+  std::vector<double> m;
+  std::vector<double> diffL, diffD, diffU;
+  std::vector<double> convL, convD, convU;
+};
+
+// Builds the grid from 0 to at least mMax, with m_i = 1 + c sinh(xi_i) and xi_i uniform,
+// so that the nodes are densest around the strike, which falls on a node
+FdGrid makeGrid(size_t n, double mMax, double c, double volatility)
+{
+  double xiMin = asinh(-1.0 / c);
+  double xiMax = asinh((mMax - 1.0) / c);
+  size_t nLeft = static_cast<size_t>(floor((n - 1) * (-xiMin) / (xiMax - xiMin)));
+  nLeft = std::min(std::max<size_t>(nLeft, 2), n - 3);
+  double dxi = -xiMin / nLeft;
+
+  FdGrid g;
+  g.m.resize(n);
+  for (size_t i = 0; i < n; ++i)
+    g.m[i] = 1.0 + c * sinh(xiMin + i * dxi);
+  g.m[0] = 0.0;
+  g.m[nLeft] = 1.0;
+
+  g.diffL.assign(n, 0.0);
+  g.diffD.assign(n, 0.0);
+  g.diffU.assign(n, 0.0);
+  g.convL.assign(n, 0.0);
+  g.convD.assign(n, 0.0);
+  g.convU.assign(n, 0.0);
+  double hvol2 = 0.5 * volatility * volatility;
+  // node 0 is m = 0, where the PDE reduces to dv/dt = r v and both operators vanish
+  for (size_t i = 1; i + 1 < n; ++i) {
+    double hm = g.m[i] - g.m[i - 1], hp = g.m[i + 1] - g.m[i];
+    double a = hvol2 * g.m[i] * g.m[i];
+    g.diffL[i] = a * 2.0 / (hm * (hm + hp));
+    g.diffD[i] = -a * 2.0 / (hm * hp);
+    g.diffU[i] = a * 2.0 / (hp * (hm + hp));
+    g.convL[i] = -g.m[i] * hp / (hm * (hm + hp));
+    g.convD[i] = g.m[i] * (hp - hm) / (hm * hp);
+    g.convU[i] = g.m[i] * hm / (hp * (hm + hp));
+  }
+  // last node: the price is linear in m, no diffusion and a one-sided first derivative
+  double h = g.m[n - 1] - g.m[n - 2];
+  g.convL[n - 1] = -g.m[n - 1] / h;
+  g.convD[n - 1] = g.m[n - 1] / h;
+  return g;
+}
+
+// Advances v on the grid by theta-scheme time steps, keeping the factored system
+// of the last step for as long as the step size, theta and rate do not change
+class FdStepper
+{
+public:
+  FdStepper(FdGrid const& grid, double divYield, std::vector<double> const* exercise)
+  : grid_(grid), divYield_(divYield), exercise_(exercise), n_(grid.m.size()),
+    dt_(-1.0), theta_(-1.0), rate_(0.0),
+    lower_(n_), diag_(n_), upper_(n_), rhs_(n_), work_(n_), active_(n_, 0), factored_(n_, 0)
+  {}
+
+  void step(std::vector<double>& v, double dt, double theta, double rate)
+  {
+    if (dt != dt_ || theta != theta_ || fabs(rate - rate_) > FD_RATE_TOL * (1.0 + fabs(rate))) {
+      dt_ = dt;
+      theta_ = theta;
+      rate_ = rate;
+      double mu = rate - divYield_;
+      for (size_t i = 0; i < n_; ++i) {
+        lower_[i] = grid_.diffL[i] + mu * grid_.convL[i];
+        diag_[i] = grid_.diffD[i] + mu * grid_.convD[i] - rate;
+        upper_[i] = grid_.diffU[i] + mu * grid_.convU[i];
+      }
+      std::fill(factored_.begin(), factored_.end(), 0);
+      factor();
+    }
+
+    // explicit part
+    double e = (1.0 - theta) * dt;
+    if (e > 0.0) {
+      rhs_[0] = v[0] + e * diag_[0] * v[0];
+      for (size_t i = 1; i + 1 < n_; ++i)
+        rhs_[i] = v[i] + e * (lower_[i] * v[i - 1] + diag_[i] * v[i] + upper_[i] * v[i + 1]);
+      rhs_[n_ - 1] = v[n_ - 1] + e * (lower_[n_ - 1] * v[n_ - 2] + diag_[n_ - 1] * v[n_ - 1]);
+    }
+    else {
+      std::copy(v.begin(), v.end(), rhs_.begin());
+    }
+
+    if (!exercise_) {
+      solver_.solve(rhs_.data(), v.data());
+      return;
+    }
+
+    // penalty iteration: solve with a large penalty where the previous iterate is below exercise,
+    // until the set of penalized nodes no longer changes
+    std::vector<double> const& g = *exercise_;
+    for (size_t iter = 0; iter < FD_MAX_PENALTY_ITER; ++iter) {
+      for (size_t i = 0; i < n_; ++i)
+        active_[i] = v[i] < g[i];
+      if (iter > 0 && active_ == factored_)
+        break;
+      if (active_ != factored_) {
+        factored_ = active_;
+        factor();
+      }
+      for (size_t i = 0; i < n_; ++i)
+        work_[i] = factored_[i] ? rhs_[i] + FD_PENALTY * g[i] : rhs_[i];
+      solver_.solve(work_.data(), v.data());
+    }
+  }
+
+private:
+  // factors I - theta dt L, plus the penalty on the nodes in factored_
+  void factor()
+  {
+    double s = theta_ * dt_;
+    std::vector<double> a(n_), b(n_), c(n_);
+    for (size_t i = 0; i < n_; ++i) {
+      a[i] = -s * lower_[i];
+      b[i] = 1.0 - s * diag_[i] + (factored_[i] ? FD_PENALTY : 0.0);
+      c[i] = -s * upper_[i];
+    }
+    solver_.factor(n_, a.data(), b.data(), c.data());
+  }
+
+  FdGrid const& grid_;
+  double divYield_;
+  std::vector<double> const* exercise_;
+  size_t n_;
+  double dt_, theta_, rate_;
+  std::vector<double> lower_, diag_, upper_;   // the operator L of the current rate
+  std::vector<double> rhs_, work_;
+  std::vector<char> active_, factored_;        // penalized nodes of the iterate and of the factorization
+  TridiagonalSolver solver_;
+};
+
+// Cubic Lagrange interpolation of v at x on the grid m
+double interpolate(std::vector<double> const& m, std::vector<double> const& v, double x)
+{
+  size_t n = m.size();
+  size_t k = std::upper_bound(m.begin(), m.end(), x) - m.begin();
+  size_t j = std::min(k < 2 ? 0 : k - 2, n - 4);
+  double res = 0.0;
+  for (size_t p = j; p < j + 4; ++p) {
+    double w = v[p];
+    for (size_t q = j; q < j + 4; ++q)
+      if (q != p)
+        w *= (x - m[q]) / (m[p] - m[q]);
+    res += w;
+  }
+  return res;
+}
+
+} // anonymous namespace
+
+/** Prices of a strip of European or American vanilla options by finite differences */
+void fdGBM(int payoffType, bool american, double spot, double divYield, double volatility,
+           SPtrYieldCurve const& spyc, size_t nStrikes, double const* strikes,
+           size_t nMats, double const* timeToExp, double* prices, FdParams const& params)
+{
+  QF_ASSERT(payoffType == 1 || payoffType == -1, "payoffType must be 1 or -1");
+  QF_ASSERT(spot > 0.0, "spot must be positive");
+  QF_ASSERT(divYield >= 0.0, "dividend yield must be non-negative");
+  QF_ASSERT(volatility > 0.0, "volatility must be positive");
+  QF_ASSERT(spyc, "yield curve must not be null");
+  QF_ASSERT(nStrikes > 0 && nMats > 0, "at least one strike and one maturity are required");
+  QF_ASSERT(params.nSpaceNodes >= 10, "the number of space nodes must be at least 10");
+  QF_ASSERT(params.nTimeSteps > params.nRannacherSteps, "the number of time steps must exceed the Rannacher steps");
+  QF_ASSERT(params.theta >= 0.5 && params.theta <= 1.0, "theta must be between 0.5 and 1");
+  QF_ASSERT(params.concentration > 0.0, "grid concentration must be positive");
+  QF_ASSERT(params.nStdDevs > 0.0, "the number of standard deviations must be positive");
+  double mHi = 1.0;
+  for (size_t j = 0; j < nStrikes; ++j) {
+    QF_ASSERT(strikes[j] > 0.0, "strikes must be positive");
+    mHi = std::max(mHi, spot / strikes[j]);
+  }
+  for (size_t k = 0; k < nMats; ++k)
+    QF_ASSERT(timeToExp[k] > 0.0, "times to expiration must be positive");
+
+  threadPool().parallelFor(nMats, [&](size_t k) {
+    double T = timeToExp[k];
+    double drift = std::max(0.0, -log(spyc->discount(T)) - divYield * T);
+    double mMax = mHi * exp(drift + params.nStdDevs * volatility * sqrt(T));
+    double c = params.concentration * volatility * sqrt(T);
+    FdGrid grid = makeGrid(params.nSpaceNodes, mMax, c, volatility);
+
+    // payoff of the option with unit strike
+    size_t n = grid.m.size();
+    std::vector<double> v(n);
+    for (size_t i = 0; i < n; ++i)
+      v[i] = std::max(payoffType * (grid.m[i] - 1.0), 0.0);
+    std::vector<double> exercise;
+    if (american)
+      exercise = v;
+    FdStepper stepper(grid, divYield, american ? &exercise : nullptr);
+
+    // backward in calendar time, from T to 0
+    double dt = T / params.nTimeSteps;
+    for (size_t s = 0; s < params.nTimeSteps; ++s) {
+      double t1 = s + 1 == params.nTimeSteps ? 0.0 : T - (s + 1) * dt;
+      double t2 = T - s * dt;
+      double rate = -log(spyc->fwdDiscount(t1, t2)) / (t2 - t1);
+      if (s < params.nRannacherSteps) {
+        stepper.step(v, 0.5 * dt, 1.0, rate);
+        stepper.step(v, 0.5 * dt, 1.0, rate);
+      }
+      else {
+        stepper.step(v, dt, params.theta, rate);
+      }
+    }
+
+    for (size_t j = 0; j < nStrikes; ++j)
+      prices[k * nStrikes + j] = strikes[j] * interpolate(grid.m, v, spot / strikes[j]);
+  });
+}
+
+/** Price of a European or American vanilla option by finite differences */
+double fdGBM(int payoffType, bool american, double spot, double strike, double timeToExp,
+             double divYield, double volatility, SPtrYieldCurve const& spyc, FdParams const& params)
+{
+  double price;
+  fdGBM(payoffType, american, spot, divYield, volatility, spyc, 1, &strike, 1, &timeToExp, &price, params);
+  return price;
+}
+
+END_NAMESPACE(qf)
@@ -0,0 +1,49 @@
+/**
+@file  fdengine.hpp
+@brief Finite difference pricing of European and American options
+*/
+
+#ifndef QF_FDENGINE_HPP
+#define QF_FDENGINE_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <qflib/market/yieldcurve.hpp>
+
+BEGIN_NAMESPACE(qf)
+
+/** Finite difference solver parameters */
+struct FdParams
+{
+  size_t nSpaceNodes = 400;     // number of nodes of the price grid
+  size_t nTimeSteps = 200;      // number of time steps to each maturity
+  double theta = 0.5;           // 0.5 for Crank-Nicolson, 1 for fully implicit
+  size_t nRannacherSteps = 2;   // first time steps replaced by two fully implicit half steps each
+  double concentration = 0.5;   // width of the fine region of the grid around the strike, in standard deviations
+  double nStdDevs = 5.0;        // upper end of the grid, in standard deviations of the log price
+};
+
+/** Prices of European or American vanilla options in the Black-Scholes model with the rates
+    of a yield curve, by solving the Black-Scholes PDE with the theta scheme.
+    The price is homogeneous in spot and strike, V(S, K) = K v(S/K), so the PDE is solved for
+    v on a grid of moneyness S/K, concentrated around 1 by a sinh transform with the strike on a node.
+    One backward solve per maturity prices all strikes of the strip; the maturities are solved
+    in parallel on threadPool().
+    Rannacher start-up steps damp the oscillations of Crank-Nicolson from the payoff kink.
+    Each step uses the forward rate of the yield curve over the step; the factorization of the
+    tridiagonal system is reused while the rate and step size do not change.
+    American exercise is enforced by the penalty method of Forsyth and Vetzal (2002).
+    The prices are written to prices[iMat * nStrikes + iStrike].
+*/
+void fdGBM(int payoffType, bool american, double spot, double divYield, double volatility,
+           SPtrYieldCurve const& spyc, size_t nStrikes, double const* strikes,
+           size_t nMats, double const* timeToExp, double* prices, FdParams const& params = FdParams());
+
+/** Price of a European or American vanilla option by finite differences; see the strip version */
+double fdGBM(int payoffType, bool american, double spot, double strike, double timeToExp,
+             double divYield, double volatility, SPtrYieldCurve const& spyc,
+             FdParams const& params = FdParams());
+
+END_NAMESPACE(qf)
+
+#endif // QF_FDENGINE_HPP
@@ -0,0 +1,200 @@
+/**
+@file  bsgreeks.cpp
+@brief Implementation of one-pass price and Greeks functions in the Black-Scholes model
+*/
+
+#include <qflib/pricers/bsgreeks.hpp>
+#include <qflib/math/stats/normaldistribution.hpp>
+
+#include <cmath>
+#include <string>
+#include <algorithm>
+
+BEGIN_NAMESPACE(qf)
+
+namespace {
+
+// Number of options processed per block by the batch functions
+const size_t GREEKS_BLOCK_SIZE = 256;
+
+// Returns true if the inputs of one option are valid
+inline bool validInputs(int payoffType, double spot, double strike, double timeToExp,
+                        double intRate, double divYield, double volatility)
+{
+  return (payoffType == 1 || payoffType == -1) && spot >= 0.0 && strike >= 0.0 && timeToExp > 0.0
+    && intRate >= 0.0 && divYield >= 0.0 && volatility > 0.0;
+}
+
+// Validates the inputs of one option; suffix is appended to the error messages
+void validateInputs(int payoffType, double spot, double strike, double timeToExp,
+                    double intRate, double divYield, double volatility, std::string const& suffix)
+{
+  QF_ASSERT(payoffType == 1 || payoffType == -1, "payoffType must be 1 or -1" + suffix);
+  QF_ASSERT(spot >= 0.0, "spot must be non-negative" + suffix);
+  QF_ASSERT(strike >= 0.0, "strike must be non-negative" + suffix);
+  QF_ASSERT(timeToExp > 0.0, "time to expiration must be positive" + suffix);
+  QF_ASSERT(intRate >= 0.0, "interest rate must be non-negative" + suffix);
+  QF_ASSERT(divYield >= 0.0, "dividend yield must be non-negative" + suffix);
+  QF_ASSERT(volatility > 0.0, "volatility must be positive" + suffix);
+}
+
+// Validates the inputs of a batch of options
+void validateBatch(size_t nOpts, int const* payoffType, double const* spot, double const* strike,
+                   double const* timeToExp, double const* intRate, double const* divYield,
+                   double const* volatility)
+{
+  for (size_t i = 0; i < nOpts; ++i) {
+    if (!validInputs(payoffType[i], spot[i], strike[i], timeToExp[i], intRate[i], divYield[i], volatility[i]))
+      validateInputs(payoffType[i], spot[i], strike[i], timeToExp[i], intRate[i], divYield[i], volatility[i],
+        "; option " + std::to_string(i));
+  }
+}
+
+// Quantities shared by the price and all sensitivities of one option
+struct BSTerms
+{
+  double phi, spot, strike, timeToExp, intRate, divYield, vol;
+  double sqrtT, sigT, fwd, dfr, dfq, d1, d2;
+};
+
+inline BSTerms bsTerms(int payoffType, double spot, double strike, double timeToExp,
+                       double intRate, double divYield, double volatility)
+{
+  BSTerms b;
+  b.phi = payoffType;
+  b.spot = spot;
+  b.strike = strike;
+  b.timeToExp = timeToExp;
+  b.intRate = intRate;
+  b.divYield = divYield;
+  b.vol = volatility;
+  b.sqrtT = sqrt(timeToExp);
+  b.sigT = volatility * b.sqrtT;
+  b.fwd = spot * exp((intRate - divYield) * timeToExp);
+  b.dfr = exp(-intRate * timeToExp);
+  b.dfq = exp(-divYield * timeToExp);
+  b.d1 = log(b.fwd / strike) / b.sigT + 0.5 * b.sigT;
+  b.d2 = b.d1 - b.sigT;
+  return b;
+}
+
+// European option Greeks; Nd1 = N(phi d1), Nd2 = N(phi d2), nd1 = n(d1)
+inline BSGreeks europeanGreeks(BSTerms const& b, double Nd1, double Nd2, double nd1)
+{
+  BSGreeks g;
+  double phi = b.phi, S = b.spot, K = b.strike, T = b.timeToExp;
+  double r = b.intRate, q = b.divYield, vol = b.vol;
+  double sdn = S * b.dfq * nd1;    // S e^{-qT} n(d1) = K e^{-rT} n(d2)
+
+  g.price = (b.fwd * Nd1 - K * Nd2) * (phi * b.dfr);
+  g.delta = phi * b.dfq * Nd1;
+  g.gamma = b.dfq * nd1 / (S * b.sigT);
+  g.vega = sdn * b.sqrtT;
+  g.theta = -0.5 * sdn * vol / b.sqrtT - phi * r * K * b.dfr * Nd2 + phi * q * S * b.dfq * Nd1;
+  g.rho = phi * K * T * b.dfr * Nd2;
+  g.divRho = -phi * S * T * b.dfq * Nd1;
+  g.vanna = -b.dfq * nd1 * b.d2 / vol;
+  g.volga = g.vega * b.d1 * b.d2 / vol;
+  g.charm = phi * q * b.dfq * Nd1 - b.dfq * nd1 * (2.0 * (r - q) * T - b.d2 * b.sigT) / (2.0 * T * b.sigT);
+  return g;
+}
+
+// Digital option Greeks; Nd2 = N(phi d2), nd2 = n(d2)
+inline BSGreeks digitalGreeks(BSTerms const& b, double Nd2, double nd2)
+{
+  BSGreeks g;
+  double phi = b.phi, S = b.spot, T = b.timeToExp;
+  double r = b.intRate, q = b.divYield, vol = b.vol;
+  double dn = b.dfr * nd2;
+  double dd2dT = (r - q) / b.sigT - 0.5 * b.d1 / T;   // derivative of d2 w.r.t. T
+
+  g.price = b.dfr * Nd2;
+  g.delta = phi * dn / (S * b.sigT);
+  g.gamma = -phi * dn * b.d1 / (S * S * b.sigT * b.sigT);
+  g.vega = -phi * dn * b.d1 / vol;
+  g.theta = r * g.price - phi * dn * dd2dT;
+  g.rho = -T * g.price + phi * dn * b.sqrtT / vol;
+  g.divRho = -phi * dn * b.sqrtT / vol;
+  g.vanna = phi * dn * (b.d1 * b.d2 - 1.0) / (S * vol * b.sigT);
+  g.volga = -phi * dn * (b.d1 * b.d1 * b.d2 - b.d2 - b.d1) / (vol * vol);
+  g.charm = g.delta * (r + b.d2 * dd2dT + 0.5 / T);
+  return g;
+}
+
+} // anonymous namespace
+
+/** Price and Greeks of a European digital option in the Black-Scholes model */
+BSGreeks digitalOptionBSGreeks(int payoffType, double spot, double strike, double timeToExp,
+                               double intRate, double divYield, double volatility)
+{
+  validateInputs(payoffType, spot, strike, timeToExp, intRate, divYield, volatility, "");
+
+  BSTerms b = bsTerms(payoffType, spot, strike, timeToExp, intRate, divYield, volatility);
+  NormalDistribution normal;
+  return digitalGreeks(b, normal.cdf(b.phi * b.d2), normal.pdf(b.d2));
+}
+
+/** Price and Greeks of a European option in the Black-Scholes model */
+BSGreeks europeanOptionBSGreeks(int payoffType, double spot, double strike, double timeToExp,
+                                double intRate, double divYield, double volatility)
+{
+  validateInputs(payoffType, spot, strike, timeToExp, intRate, divYield, volatility, "");
+
+  BSTerms b = bsTerms(payoffType, spot, strike, timeToExp, intRate, divYield, volatility);
+  NormalDistribution normal;
+  return europeanGreeks(b, normal.cdf(b.phi * b.d1), normal.cdf(b.phi * b.d2), normal.pdf(b.d1));
+}
+
+/** Price and Greeks of a batch of European digital options in the Black-Scholes model */
+void digitalOptionBSGreeks(size_t nOpts, int const* payoffType, double const* spot, double const* strike,
+                           double const* timeToExp, double const* intRate, double const* divYield,
+                           double const* volatility, BSGreeks* greeks)
+{
+  validateBatch(nOpts, payoffType, spot, strike, timeToExp, intRate, divYield, volatility);
+
+  NormalDistribution normal;
+  BSTerms terms[GREEKS_BLOCK_SIZE];
+  double cd2[GREEKS_BLOCK_SIZE], pd2[GREEKS_BLOCK_SIZE];
+  for (size_t ib = 0; ib < nOpts; ib += GREEKS_BLOCK_SIZE) {
+    size_t nb = std::min(GREEKS_BLOCK_SIZE, nOpts - ib);
+    for (size_t j = 0; j < nb; ++j) {
+      size_t i = ib + j;
+      terms[j] = bsTerms(payoffType[i], spot[i], strike[i], timeToExp[i], intRate[i], divYield[i], volatility[i]);
+      cd2[j] = terms[j].phi * terms[j].d2;
+      pd2[j] = terms[j].d2;
+    }
+    normal.cdf(nb, cd2, cd2);
+    normal.pdf(nb, pd2, pd2);
+    for (size_t j = 0; j < nb; ++j)
+      greeks[ib + j] = digitalGreeks(terms[j], cd2[j], pd2[j]);
+  }
+}
+
+/** Price and Greeks of a batch of European options in the Black-Scholes model */
+void europeanOptionBSGreeks(size_t nOpts, int const* payoffType, double const* spot, double const* strike,
+                            double const* timeToExp, double const* intRate, double const* divYield,
+                            double const* volatility, BSGreeks* greeks)
+{
+  validateBatch(nOpts, payoffType, spot, strike, timeToExp, intRate, divYield, volatility);
+
+  NormalDistribution normal;
+  BSTerms terms[GREEKS_BLOCK_SIZE];
+  double cd1[GREEKS_BLOCK_SIZE], cd2[GREEKS_BLOCK_SIZE], pd1[GREEKS_BLOCK_SIZE];
+  for (size_t ib = 0; ib < nOpts; ib += GREEKS_BLOCK_SIZE) {
+    size_t nb = std::min(GREEKS_BLOCK_SIZE, nOpts - ib);
+    for (size_t j = 0; j < nb; ++j) {
+      size_t i = ib + j;
+      terms[j] = bsTerms(payoffType[i], spot[i], strike[i], timeToExp[i], intRate[i], divYield[i], volatility[i]);
+      cd1[j] = terms[j].phi * terms[j].d1;
+      cd2[j] = terms[j].phi * terms[j].d2;
+      pd1[j] = terms[j].d1;
+    }
+    normal.cdf(nb, cd1, cd1);
+    normal.cdf(nb, cd2, cd2);
+    normal.pdf(nb, pd1, pd1);
+    for (size_t j = 0; j < nb; ++j)
+      greeks[ib + j] = europeanGreeks(terms[j], cd1[j], cd2[j], pd1[j]);
+  }
+}
+
+END_NAMESPACE(qf)
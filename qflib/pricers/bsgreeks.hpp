@@ -0,0 +1,63 @@
+/**
+@file  bsgreeks.hpp
+@brief Declaration of one-pass price and Greeks functions in the Black-Scholes model
+*/
+
+#ifndef QF_BSGREEKS_HPP
+#define QF_BSGREEKS_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+
+BEGIN_NAMESPACE(qf)
+
+/** Price and sensitivities of an option in the Black-Scholes model.
+    Time decays (theta, charm) are derivatives with respect to calendar time, i.e. -d/dT.
+*/
+struct BSGreeks
+{
+  double price;   // option price
+  double delta;   // dV/dS
+  double gamma;   // d2V/dS2
+  double vega;    // dV/dsigma
+  double theta;   // -dV/dT
+  double rho;     // dV/dr
+  double divRho;  // dV/dq
+  double vanna;   // d2V/dSdsigma
+  double volga;   // d2V/dsigma2
+  double charm;   // -d2V/dSdT
+};
+
+/** Price and Greeks of a European digital option in the Black-Scholes model.
+    The forward, d1, d2, the discount factors and the normal pdf and cdf values are computed once
+    and shared by all sensitivities. Time to expiration and volatility must be positive.
+*/
+BSGreeks digitalOptionBSGreeks(int payoffType, double spot, double strike, double timeToExp,
+                               double intRate, double divYield, double volatility);
+
+/** Price and Greeks of a European option in the Black-Scholes model.
+    The forward, d1, d2, the discount factors and the normal pdf and cdf values are computed once
+    and shared by all sensitivities. Time to expiration and volatility must be positive.
+*/
+BSGreeks europeanOptionBSGreeks(int payoffType, double spot, double strike, double timeToExp,
+                                double intRate, double divYield, double volatility);
+
+/** Price and Greeks of a batch of European digital options in the Black-Scholes model.
+    The inputs are contiguous arrays of length nOpts, one element per option;
+    the results are written to greeks[0, nOpts). All inputs are validated once, before any computation.
+*/
+void digitalOptionBSGreeks(size_t nOpts, int const* payoffType, double const* spot, double const* strike,
+                           double const* timeToExp, double const* intRate, double const* divYield,
+                           double const* volatility, BSGreeks* greeks);
+
+/** Price and Greeks of a batch of European options in the Black-Scholes model.
+    The inputs are contiguous arrays of length nOpts, one element per option;
+    the results are written to greeks[0, nOpts). All inputs are validated once, before any computation.
+*/
+void europeanOptionBSGreeks(size_t nOpts, int const* payoffType, double const* spot, double const* strike,
+                            double const* timeToExp, double const* intRate, double const* divYield,
+                            double const* volatility, BSGreeks* greeks);
+
+END_NAMESPACE(qf)
+
+#endif // QF_BSGREEKS_HPP
@@ -0,0 +1,276 @@
+/**
+@file  impliedvol.cpp
+@brief Implementation of implied volatility functions for the Black-Scholes model
+*/
+
+#include <qflib/pricers/impliedvol.hpp>
+#include <qflib/math/stats/normaldistribution.hpp>
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+BEGIN_NAMESPACE(qf)
+
+namespace {
+
+// Number of options processed per block by the batch function
+const size_t IV_BLOCK_SIZE = 256;
+// Householder steps applied to a whole block
+const int IV_BLOCK_ITER = 3;
+// Maximum number of steps of the scalar iteration
+const int IV_MAX_ITER = 30;
+// Convergence tolerance, relative to the normalized volatility
+const double IV_TOL = 1e-13;
+// Relative accuracy of the normal cdf near the origin; in the tails it degrades like h^2 (see ErrorFunction)
+const double IV_CDF_ACCURACY = 1e-14;
+
+/* The normalized problem.
+   With F the forward, x = -|ln(F/K)| and s = vol * sqrt(T), every option is converted to the
+   out-of-the-money call with normalized price b(x, s) = e^{x/2} N(x/s + s/2) - e^{-x/2} N(x/s - s/2),
+   which has the same time value beta as the original option.
+*/
+struct IVProblem
+{
+  double x;       // -|ln(F/K)|
+  double beta;    // normalized time value, in [0, e^{x/2})
+  double sqrtT;   // sqrt of time to expiration
+  bool lower;     // true if beta is below the inflection point value b(x, sqrt(2|x|))
+};
+
+// Normalizes one quote; returns OK or the reason why it has no implied volatility
+ImpliedVolStatus normalize(int payoffType, double price, double spot, double strike, double timeToExp,
+                           double intRate, double divYield, IVProblem& pb)
+{
+  if (!((payoffType == 1 || payoffType == -1) && spot > 0.0 && strike > 0.0 && timeToExp > 0.0
+        && intRate >= 0.0 && divYield >= 0.0 && price >= 0.0))
+    return ImpliedVolStatus::INVALID_INPUT;
+  if (!(std::isfinite(price) && std::isfinite(spot) && std::isfinite(strike) && std::isfinite(timeToExp)
+        && std::isfinite(intRate) && std::isfinite(divYield)))
+    return ImpliedVolStatus::INVALID_INPUT;
+
+  double fwd = spot * exp((intRate - divYield) * timeToExp);
+  double df = exp(-intRate * timeToExp);
+  double b = price / (df * sqrt(fwd * strike));   // normalized undiscounted price
+  // finite inputs can still overflow or underflow the forward and discount factor
+  if (!(fwd > 0.0 && std::isfinite(fwd) && df > 0.0 && std::isfinite(b)))
+    return ImpliedVolStatus::INVALID_INPUT;
+  double lnfk = log(fwd / strike);
+  double ehalf = exp(0.5 * lnfk);
+  double intrinsic = std::max(payoffType * (ehalf - 1.0 / ehalf), 0.0);
+  double bmax = payoffType == 1 ? ehalf : 1.0 / ehalf;
+
+  if (b >= bmax)
+    return ImpliedVolStatus::ABOVE_MAXIMUM;
+  if (b < intrinsic - 8.0 * std::numeric_limits<double>::epsilon() * bmax)   // allow for rounding
+    return ImpliedVolStatus::BELOW_INTRINSIC;
+
+  pb.x = -std::abs(lnfk);
+  pb.beta = std::max(b - intrinsic, 0.0);
+  pb.sqrtT = sqrt(timeToExp);
+  // ratios to a subnormal beta overflow, so the iteration would not stay finite
+  if (pb.beta > 0.0 && pb.beta < std::numeric_limits<double>::min())
+    return ImpliedVolStatus::PRICE_UNDERFLOW;
+  return ImpliedVolStatus::OK;
+}
+
+// Normalized price b(x, s) from N1 = N(x/s + s/2) and N2 = N(x/s - s/2)
+inline double normalizedPrice(double x, double N1, double N2)
+{
+  return exp(0.5 * x) * N1 - exp(-0.5 * x) * N2;
+}
+
+// Initial guess of s. bc is the normalized price at the inflection point sc = sqrt(2|x|),
+// pu = (e^{x/2} - beta) / (e^{x/2} + e^{-x/2}) and su = -2 Ninv(pu) the guess of the upper limit.
+inline double initialGuess(IVProblem const& pb, double bc, double su)
+{
+  double sc = sqrt(-2.0 * pb.x);
+  if (!pb.lower)
+    return std::max(sc, su);
+  // from ln b(s) ~ ln b(sc) + ln(s/sc) - x^2/(2s^2) + x^2/(2sc^2), solved by fixed point iteration
+  double u = -0.5 * pb.x + 2.0 * log(bc / pb.beta);
+  double s = -pb.x / sqrt(u);
+  for (int i = 0; i < 2; ++i)
+    s = -pb.x / sqrt(std::max(u + 2.0 * log(s / sc), 0.25 * u));
+  return s;
+}
+
+// One third order Householder step from s; N1 = N(x/s + s/2), N2 = N(x/s - s/2). Returns the new s
+// and writes to tol the convergence tolerance on the step, no smaller than the error of s
+// induced by the rounding error of b.
+inline double householderStep(IVProblem const& pb, double s, double N1, double N2, double& tol)
+{
+  double x = pb.x;
+  double b1 = exp(0.5 * x) * N1, b2 = exp(-0.5 * x) * N2;
+  double b = b1 - b2;
+  double h = x / s, t = 0.5 * s;
+  double bp = M_1_SQRT2PI * exp(-0.5 * (h * h + t * t));   // db/ds
+  tol = std::max(IV_TOL * s, IV_CDF_ACCURACY * (1.0 + h * h) * (b1 + b2) / bp);
+  double x2s3 = x * x / (s * s * s);
+  double r2 = x2s3 - 0.25 * s;                            // b''/b'
+  double r3 = r2 * r2 - 3.0 * x2s3 / s - 0.25;            // b'''/b'
+
+  double nu, H2, H3;
+  if (pb.lower) {
+    if (!(b > 0.0))                     // b underflowed, s is far too small
+      return 2.0 * s;
+    double q = bp / b;
+    nu = -log(b / pb.beta) / q;
+    H2 = r2 - q;
+    H3 = r3 - 3.0 * r2 * q + 2.0 * q * q;
+  }
+  else {
+    nu = -(b - pb.beta) / bp;
+    H2 = r2;
+    H3 = r3;
+  }
+  double den = 1.0 + nu * (H2 + H3 * nu / 6.0);
+  double ds = nu * (1.0 + 0.5 * H2 * nu) / den;
+  if (!(den > 0.0 && ds * nu > 0.0 && std::isfinite(ds)))   // far from the root: Newton step
+    ds = nu;
+  double snew = s + ds;
+  if (!(snew > 0.0))
+    snew = 0.5 * s;
+  else if (!std::isfinite(snew))
+    snew = 2.0 * s;
+  return snew;
+}
+
+// Returns true if s can be passed to householderStep; the normal cdf must not get non-finite values
+inline bool validGuess(double s)
+{
+  return s > 0.0 && std::isfinite(s);
+}
+
+// Iterates from s until convergence; returns the status and writes the solution to s
+ImpliedVolStatus iterate(IVProblem const& pb, double& s)
+{
+  if (!validGuess(s))
+    return ImpliedVolStatus::NOT_CONVERGED;
+  NormalDistribution normal;
+  for (int i = 0; i < IV_MAX_ITER; ++i) {
+    double h = pb.x / s, t = 0.5 * s;
+    double tol;
+    double snew = householderStep(pb, s, normal.cdf(h + t), normal.cdf(h - t), tol);
+    bool done = std::abs(snew - s) <= tol;
+    s = snew;
+    if (done)
+      return ImpliedVolStatus::OK;
+  }
+  return ImpliedVolStatus::NOT_CONVERGED;
+}
+
+// Inflection point price bc and upper limit guess su of one problem
+void guessTerms(IVProblem const& pb, double& bc, double& su)
+{
+  NormalDistribution normal;
+  double sc = sqrt(-2.0 * pb.x);
+  bc = sc > 0.0 ? normalizedPrice(pb.x, normal.cdf(pb.x / sc + 0.5 * sc), normal.cdf(pb.x / sc - 0.5 * sc)) : 0.0;
+  double eh = exp(0.5 * pb.x);
+  double pu = (eh - pb.beta) / (eh + 1.0 / eh);
+  su = -2.0 * InverseNormal::as241(pu);
+}
+
+} // anonymous namespace
+
+/** Implied volatility of a European option in the Black-Scholes model */
+double impliedVolBS(int payoffType, double price, double spot, double strike, double timeToExp,
+                    double intRate, double divYield, ImpliedVolStatus& status)
+{
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  IVProblem pb;
+  status = normalize(payoffType, price, spot, strike, timeToExp, intRate, divYield, pb);
+  if (status != ImpliedVolStatus::OK)
+    return nan;
+  if (pb.beta == 0.0)
+    return 0.0;
+
+  double bc, su;
+  guessTerms(pb, bc, su);
+  pb.lower = pb.beta < bc;
+  double s = initialGuess(pb, bc, su);
+  status = iterate(pb, s);
+  return status == ImpliedVolStatus::OK ? s / pb.sqrtT : nan;
+}
+
+/** Implied volatilities of a batch of European options in the Black-Scholes model */
+void impliedVolBS(size_t nOpts, int const* payoffType, double const* price, double const* spot,
+                  double const* strike, double const* timeToExp, double const* intRate,
+                  double const* divYield, double* vol, ImpliedVolStatus* status)
+{
+  const double nan = std::numeric_limits<double>::quiet_NaN();
+  NormalDistribution normal;
+  IVProblem pb[IV_BLOCK_SIZE];
+  double s[IV_BLOCK_SIZE], ds[IV_BLOCK_SIZE], tol[IV_BLOCK_SIZE], n1[IV_BLOCK_SIZE], n2[IV_BLOCK_SIZE];
+  bool active[IV_BLOCK_SIZE];
+
+  for (size_t ib = 0; ib < nOpts; ib += IV_BLOCK_SIZE) {
+    size_t nb = std::min(IV_BLOCK_SIZE, nOpts - ib);
+
+    // normalize; inactive elements get a harmless dummy problem so that the block stays branch free
+    for (size_t j = 0; j < nb; ++j) {
+      size_t i = ib + j;
+      status[i] = normalize(payoffType[i], price[i], spot[i], strike[i], timeToExp[i],
+                            intRate[i], divYield[i], pb[j]);
+      active[j] = status[i] == ImpliedVolStatus::OK && pb[j].beta > 0.0;
+      if (!active[j]) {
+        pb[j].x = -1.0;
+        pb[j].beta = 0.1;
+        pb[j].sqrtT = 1.0;
+      }
+      // at the money forward there is no inflection point and bc = 0, as in guessTerms
+      double sc = sqrt(-2.0 * pb[j].x);
+      n1[j] = sc > 0.0 ? pb[j].x / sc + 0.5 * sc : 0.0;
+      n2[j] = sc > 0.0 ? pb[j].x / sc - 0.5 * sc : 0.0;
+      double eh = exp(0.5 * pb[j].x);
+      s[j] = (eh - pb[j].beta) / (eh + 1.0 / eh);
+    }
+    // initial guesses
+    normal.cdf(nb, n1, n1);
+    normal.cdf(nb, n2, n2);
+    InverseNormal::invcdf(nb, s, s);
+    for (size_t j = 0; j < nb; ++j) {
+      double bc = pb[j].x < 0.0 ? normalizedPrice(pb[j].x, n1[j], n2[j]) : 0.0;
+      pb[j].lower = pb[j].beta < bc;
+      s[j] = initialGuess(pb[j], bc, -2.0 * s[j]);
+      if (active[j] && !validGuess(s[j])) {
+        status[ib + j] = ImpliedVolStatus::NOT_CONVERGED;
+        active[j] = false;
+      }
+      if (!active[j])
+        s[j] = 1.0;   // keeps the dummy elements finite
+    }
+    // fixed number of Householder steps on the whole block
+    for (int it = 0; it < IV_BLOCK_ITER; ++it) {
+      for (size_t j = 0; j < nb; ++j) {
+        double h = pb[j].x / s[j], t = 0.5 * s[j];
+        n1[j] = h + t;
+        n2[j] = h - t;
+      }
+      normal.cdf(nb, n1, n1);
+      normal.cdf(nb, n2, n2);
+      for (size_t j = 0; j < nb; ++j) {
+        double snew = householderStep(pb[j], s[j], n1[j], n2[j], tol[j]);
+        ds[j] = snew - s[j];
+        s[j] = snew;
+      }
+    }
+    // results; elements not yet converged continue one by one
+    for (size_t j = 0; j < nb; ++j) {
+      size_t i = ib + j;
+      if (status[i] != ImpliedVolStatus::OK) {
+        vol[i] = nan;
+        continue;
+      }
+      if (!active[j]) {   // zero time value
+        vol[i] = 0.0;
+        continue;
+      }
+      if (!(std::abs(ds[j]) <= tol[j]))
+        status[i] = iterate(pb[j], s[j]);
+      vol[i] = status[i] == ImpliedVolStatus::OK ? s[j] / pb[j].sqrtT : nan;
+    }
+  }
+}
+
+END_NAMESPACE(qf)
@@ -0,0 +1,47 @@
+/**
+@file  impliedvol.hpp
+@brief Declaration of implied volatility functions for the Black-Scholes model
+*/
+
+#ifndef QF_IMPLIEDVOL_HPP
+#define QF_IMPLIEDVOL_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+
+BEGIN_NAMESPACE(qf)
+
+/** Outcome of an implied volatility calculation */
+enum class ImpliedVolStatus
+{
+  OK,               // converged; the volatility is valid
+  INVALID_INPUT,    // payoff type, spot, strike, time, rates or price out of range or not finite
+  BELOW_INTRINSIC,  // price below the intrinsic value
+  ABOVE_MAXIMUM,    // price at or above the upper bound (forward or strike, discounted)
+  NOT_CONVERGED,    // the iteration limit was reached
+  PRICE_UNDERFLOW   // the time value normalized by the forward and strike is subnormal
+};
+
+/** Implied volatility of a European option in the Black-Scholes model, i.e. the volatility
+    for which europeanOptionBS returns the given price.
+    It does not throw: the outcome is written to status and the returned volatility is NaN unless it is OK.
+    The price is normalized and converted to an out-of-the-money option; a closed-form initial guess
+    on either side of the inflection point is refined by third order Householder steps
+    (on the normalized price above the inflection point, on its logarithm below it).
+*/
+double impliedVolBS(int payoffType, double price, double spot, double strike, double timeToExp,
+                    double intRate, double divYield, ImpliedVolStatus& status);
+
+/** Implied volatilities of a batch of European options in the Black-Scholes model.
+    The inputs are contiguous arrays of length nOpts, one element per option; the volatilities
+    are written to vol[0, nOpts) and the outcomes to status[0, nOpts). It does not throw.
+    Options are processed in blocks with a fixed number of Householder steps, using the array
+    normal cdf; only the elements not converged after them are iterated further one by one.
+*/
+void impliedVolBS(size_t nOpts, int const* payoffType, double const* price, double const* spot,
+                  double const* strike, double const* timeToExp, double const* intRate,
+                  double const* divYield, double* vol, ImpliedVolStatus* status);
+
+END_NAMESPACE(qf)
+
+#endif // QF_IMPLIEDVOL_HPP
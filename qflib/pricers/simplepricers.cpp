@@ -5,62 +5,153 @@
 
 #include <qflib/pricers/simplepricers.hpp>
 #include <qflib/math/stats/normaldistribution.hpp>
+#include <qflib/threadpool.hpp>
 
 #include <cmath>
+#include <string>
+#include <algorithm>
 
 BEGIN_NAMESPACE(qf)
 
+namespace {
+
+// Number of options priced per block by the batch kernels;
+// the scratch arrays of one block stay in the L1 cache.
+// The blocks are the tasks distributed over threadPool().
+const size_t BS_BLOCK_SIZE = 256;
+
+// Validates all inputs of a batch of Black-Scholes options, 
+// applying the same checks as the scalar pricers and fwdPrice.
+void validateBSBatch(size_t nOpts, int const* payoffType, double const* spot, double const* strike,
+                     double const* timeToExp, double const* intRate, double const* divYield,
+                     double const* volatility)
+{
+  for (size_t i = 0; i < nOpts; ++i) {
+    QF_ASSERT(payoffType[i] == 1 || payoffType[i] == -1,
+      "payoffType must be 1 or -1; option " + std::to_string(i));
+    QF_ASSERT(spot[i] >= 0.0, "spot must be non-negative; option " + std::to_string(i));
+    QF_ASSERT(strike[i] >= 0.0, "strike must be non-negative; option " + std::to_string(i));
+    QF_ASSERT(timeToExp[i] >= 0.0, "time to expiration must be non-negative; option " + std::to_string(i));
+    QF_ASSERT(intRate[i] >= 0.0, "interest rate must be non-negative; option " + std::to_string(i));
+    QF_ASSERT(divYield[i] >= 0.0, "dividend yield must be non-negative; option " + std::to_string(i));
+    QF_ASSERT(volatility[i] >= 0.0, "volatility must be non-negative; option " + std::to_string(i));
+  }
+}
+
+} // anonymous namespace
+
 /** The forward price of an asset */
 double fwdPrice(double spot, double timeToExp, double intRate, double divYield)
 {
-  QF_ASSERT(spot >= 0.0, "spot must be non-negative");
-  QF_ASSERT(timeToExp >= 0.0, "time to expiration must be non-negative");
-  QF_ASSERT(intRate >= 0.0, "interest rate must be non-negative");
-  QF_ASSERT(divYield >= 0.0, "dividend yield must be non-negative");
-
-  return spot * exp((intRate - divYield) * timeToExp);
+  return fwdPrice<double>(spot, timeToExp, intRate, divYield);
 }
 
 /** Price of a European digital option in the Black-Scholes model*/
 double digitalOptionBS(int payoffType, double spot, double strike, double timeToExp,
                        double intRate, double divYield, double volatility)
 {
-  QF_ASSERT(payoffType == 1 || payoffType == -1, "payoffType must be 1 or -1");
-  QF_ASSERT(strike >= 0.0, "strike must be non-negative");
-  QF_ASSERT(divYield >= 0.0, "dividend yield must be non-negative");
-  QF_ASSERT(volatility >= 0.0, "volatility must be non-negative");
-
-  double phi = payoffType;
-  double fwd = fwdPrice(spot, timeToExp, intRate, divYield);
-  double sigT = volatility * sqrt(timeToExp);
-  double d2 = log(fwd / strike) / sigT - 0.5 * sigT;
-  NormalDistribution normal;
-
-  double price = exp(-intRate * timeToExp) * normal.cdf(phi * d2);
-
-  return price;
+  return digitalOptionBS<double>(payoffType, spot, strike, timeToExp, intRate, divYield, volatility);
 }
 
 /** Price of a European option in the Black-Scholes model*/
 double europeanOptionBS(int payoffType, double spot, double strike, double timeToExp, 
                         double intRate, double divYield, double volatility)
 {
-  QF_ASSERT(payoffType == 1 || payoffType == -1, "payoffType must be 1 or -1");
-  QF_ASSERT(strike >= 0.0, "strike must be non-negative");
-  QF_ASSERT(volatility >= 0.0, "volatility must be non-negative");
+  return europeanOptionBS<double>(payoffType, spot, strike, timeToExp, intRate, divYield, volatility);
+}
 
-  double phi = payoffType;
-  double fwd = fwdPrice(spot, timeToExp, intRate, divYield);
-  double sigT = volatility * sqrt(timeToExp);
-  double d1 = log(fwd / strike) / sigT + 0.5 * sigT;
-  double d2 = d1 - sigT;
+/** Prices of a batch of European digital options in the Black-Scholes model */
+void digitalOptionBS(size_t nOpts, int const* payoffType, double const* spot, double const* strike,
+                     double const* timeToExp, double const* intRate, double const* divYield,
+                     double const* volatility, double* price, bool reference)
+{
+  validateBSBatch(nOpts, payoffType, spot, strike, timeToExp, intRate, divYield, volatility);
+
+  if (reference) {
+    for (size_t i = 0; i < nOpts; ++i)
+      price[i] = digitalOptionBS(payoffType[i], spot[i], strike[i], timeToExp[i],
+                                 intRate[i], divYield[i], volatility[i]);
+    return;
+  }
 
   NormalDistribution normal;
-  double df = exp(-intRate * timeToExp);
-  double price = fwd * normal.cdf(phi * d1) - strike * normal.cdf(phi * d2);
-  price *= phi * df;
+  size_t nBlocks = (nOpts + BS_BLOCK_SIZE - 1) / BS_BLOCK_SIZE;
+  threadPool().parallelFor(nBlocks, [&](size_t iBlock) {
+    // the cdf arrays are value-initialized: in a short last block the compiler cannot see that
+    // the cdf reads only the nb elements written
+    double x[BS_BLOCK_SIZE] = {}, df[BS_BLOCK_SIZE];
+    size_t ib = iBlock * BS_BLOCK_SIZE;
+    size_t nb = std::min(BS_BLOCK_SIZE, nOpts - ib);
+    int const* pt = payoffType + ib;
+    double const* s = spot + ib;
+    double const* k = strike + ib;
+    double const* t = timeToExp + ib;
+    double const* r = intRate + ib;
+    double const* q = divYield + ib;
+    double const* v = volatility + ib;
+    // straight-line arithmetic, no branches or calls other than math intrinsics
+    for (size_t j = 0; j < nb; ++j) {
+      double phi = pt[j];
+      double fwd = s[j] * exp((r[j] - q[j]) * t[j]);
+      double sigT = v[j] * sqrt(t[j]);
+      double d2 = log(fwd / k[j]) / sigT - 0.5 * sigT;
+      x[j] = phi * d2;
+      df[j] = exp(-r[j] * t[j]);
+    }
+    normal.cdf(nb, x, x);
+    double* p = price + ib;
+    for (size_t j = 0; j < nb; ++j)
+      p[j] = df[j] * x[j];
+  });
+}
 
-  return price;
+/** Prices of a batch of European options in the Black-Scholes model */
+void europeanOptionBS(size_t nOpts, int const* payoffType, double const* spot, double const* strike,
+                      double const* timeToExp, double const* intRate, double const* divYield,
+                      double const* volatility, double* price, bool reference)
+{
+  validateBSBatch(nOpts, payoffType, spot, strike, timeToExp, intRate, divYield, volatility);
+
+  if (reference) {
+    for (size_t i = 0; i < nOpts; ++i)
+      price[i] = europeanOptionBS(payoffType[i], spot[i], strike[i], timeToExp[i],
+                                  intRate[i], divYield[i], volatility[i]);
+    return;
+  }
+
+  NormalDistribution normal;
+  size_t nBlocks = (nOpts + BS_BLOCK_SIZE - 1) / BS_BLOCK_SIZE;
+  threadPool().parallelFor(nBlocks, [&](size_t iBlock) {
+    // the cdf arrays are value-initialized, as in digitalOptionBS
+    double fwd[BS_BLOCK_SIZE], x1[BS_BLOCK_SIZE] = {}, x2[BS_BLOCK_SIZE] = {}, phidf[BS_BLOCK_SIZE];
+    size_t ib = iBlock * BS_BLOCK_SIZE;
+    size_t nb = std::min(BS_BLOCK_SIZE, nOpts - ib);
+    int const* pt = payoffType + ib;
+    double const* s = spot + ib;
+    double const* k = strike + ib;
+    double const* t = timeToExp + ib;
+    double const* r = intRate + ib;
+    double const* q = divYield + ib;
+    double const* v = volatility + ib;
+    // straight-line arithmetic, no branches or calls other than math intrinsics
+    for (size_t j = 0; j < nb; ++j) {
+      double phi = pt[j];
+      fwd[j] = s[j] * exp((r[j] - q[j]) * t[j]);
+      double sigT = v[j] * sqrt(t[j]);
+      double d1 = log(fwd[j] / k[j]) / sigT + 0.5 * sigT;
+      double d2 = d1 - sigT;
+      x1[j] = phi * d1;
+      x2[j] = phi * d2;
+      phidf[j] = phi * exp(-r[j] * t[j]);
+    }
+    normal.cdf(nb, x1, x1);
+    normal.cdf(nb, x2, x2);
+    double* p = price + ib;
+    for (size_t j = 0; j < nb; ++j) {
+      double pr = fwd[j] * x1[j] - k[j] * x2[j];
+      p[j] = pr * phidf[j];
+    }
+  });
 }
 
 /** Price of a caplet or floorlet using the Black-Scholes model */
@@ -71,92 +162,20 @@ double capFloorletBS(int payoffType,
   double tenor,
   double fwdRateVol)
 {
-// Validate input parameters
-QF_ASSERT(payoffType == 1 || payoffType == -1, "payoffType must be 1 (cap) or -1 (floor)");
-QF_ASSERT(strikeRate > 0.0, "strikeRate must be positive");
-QF_ASSERT(timeToReset >= 0.0, "timeToReset must be non-negative");
-QF_ASSERT(tenor > 0.0, "tenor must be positive");
-QF_ASSERT(fwdRateVol > 0.0, "fwdRateVol must be positive");
-
-
-double paymentTime = timeToReset + tenor;
-double df = spyc->discount(paymentTime);  
-double fwdRate = spyc->fwdRate(timeToReset, paymentTime);
-double fwdRateSimple = (exp(fwdRate * tenor) - 1.0) / tenor;
-double phi = payoffType;
-double sigma_sqrt_t = fwdRateVol * sqrt(timeToReset);
-double d1 = (log(fwdRateSimple / strikeRate) + 0.5 * fwdRateVol * fwdRateVol * timeToReset) / sigma_sqrt_t;
-double d2 = d1 - sigma_sqrt_t;
-
-NormalDistribution normal;
-double N_d1 = normal.cdf(phi * d1);
-double N_d2 = normal.cdf(phi * d2);
-double price = phi * df * tenor * (fwdRateSimple * N_d1 - strikeRate * N_d2);
-
-return price;
+  QF_ASSERT(spyc, "Yield curve pointer is null");
+  return capFloorletBS<double>(payoffType, *spyc, strikeRate, timeToReset, tenor, fwdRateVol);
 }
 
 Vector cdsPV(SPtrYieldCurve sprfyc, double credSprd, double cdsRate,
-  double recov, double timeToMat, double payFreq) {
-
-QF_ASSERT(sprfyc, "Yield curve pointer is null");
-QF_ASSERT(credSprd >= 0, "Credit spread must be non-negative");
-QF_ASSERT(cdsRate >= 0, "CDS rate must be non-negative");
-QF_ASSERT(recov >= 0 && recov <= 1, "Recovery rate must be between 0 and 1");
-QF_ASSERT(timeToMat > 0, "Time to maturity must be positive");
-QF_ASSERT(payFreq > 0, "Payment frequency must be positive");
-
-int numPayments = std::ceil(timeToMat * payFreq);
-
-Vector result(2);
-double defaultPV = 0.0;
-double premiumPV = 0.0;
-
-std::vector<double> paymentTimes;
-for (int i = 1; i <= numPayments; ++i) {
-double paymentTime = i / payFreq;
-if (paymentTime > timeToMat) {
- paymentTime = timeToMat;
-}
-paymentTimes.push_back(paymentTime);
-}
-
-std::vector<double> survivalProbs;
-survivalProbs.push_back(1.0); 
-
-for (size_t i = 0; i < paymentTimes.size(); ++i) {
-double survivalProb = std::exp(-credSprd * paymentTimes[i]);
-survivalProbs.push_back(survivalProb);
-}
-
-for (size_t i = 0; i < paymentTimes.size(); ++i) {
-double prevSurvivalProb = survivalProbs[i];
-double currSurvivalProb = survivalProbs[i + 1];
-double defaultProb = prevSurvivalProb - currSurvivalProb;
-
-double discountFactor = sprfyc->discount(paymentTimes[i]);
-
-defaultPV += (1.0 - recov) * defaultProb * discountFactor;
-}
-
-double prevPaymentTime = 0.0;
-
-for (size_t i = 0; i < paymentTimes.size(); ++i) {
-double paymentTime = paymentTimes[i];
-double periodLength = paymentTime - prevPaymentTime;
-
-double survivalProb = survivalProbs[i + 1];
-double discountFactor = sprfyc->discount(paymentTime);
-
-premiumPV += cdsRate * survivalProb * discountFactor * periodLength;
-
-prevPaymentTime = paymentTime;
-}
-
-result(0) = defaultPV;
-result(1) = premiumPV;
+  double recov, double timeToMat, double payFreq)
+{
+  QF_ASSERT(sprfyc, "Yield curve pointer is null");
+  std::array<double, 2> pv = cdsPV<double>(*sprfyc, credSprd, cdsRate, recov, timeToMat, payFreq);
 
-return result;
+  Vector result(2);
+  result(0) = pv[0];
+  result(1) = pv[1];
+  return result;
 }
 
 END_NAMESPACE(qf)
\ No newline at end of file
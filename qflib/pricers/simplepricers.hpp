@@ -10,7 +10,11 @@
 #include <qflib/exception.hpp>
 #include <qflib/sptr.hpp>
 #include <qflib/market/yieldcurve.hpp>
-
+#include <qflib/math/stats/normaldistribution.hpp>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <type_traits>
 
 BEGIN_NAMESPACE(qf)
 
@@ -25,12 +29,162 @@ double digitalOptionBS(int payoffType, double spot, double strike, double timeTo
 double europeanOptionBS(int payoffType, double spot, double strike, double timeToExp, 
                         double intRate, double divYield, double volatility);
 
+/** Prices of a batch of European digital options in the Black-Scholes model.
+    The inputs are contiguous arrays of length nOpts, one element per option;
+    the prices are written to price[0, nOpts).
+    All inputs are validated once, before any price is computed.
+    If reference = true, each option is priced by the scalar digitalOptionBS, 
+    giving results bit-for-bit identical to it; otherwise the normal cdf is evaluated
+    with the array kernels and may differ from it in the last few bits;
+    the options are then priced in blocks, in parallel on threadPool().
+*/
+void digitalOptionBS(size_t nOpts, int const* payoffType, double const* spot, double const* strike,
+                     double const* timeToExp, double const* intRate, double const* divYield,
+                     double const* volatility, double* price, bool reference = false);
+
+/** Prices of a batch of European options in the Black-Scholes model.
+    The inputs are contiguous arrays of length nOpts, one element per option;
+    the prices are written to price[0, nOpts).
+    All inputs are validated once, before any price is computed.
+    If reference = true, each option is priced by the scalar europeanOptionBS, 
+    giving results bit-for-bit identical to it; otherwise the normal cdf is evaluated
+    with the array kernels and may differ from it in the last few bits;
+    the options are then priced in blocks, in parallel on threadPool().
+*/
+void europeanOptionBS(size_t nOpts, int const* payoffType, double const* spot, double const* strike,
+                      double const* timeToExp, double const* intRate, double const* divYield,
+                      double const* volatility, double* price, bool reference = false);
+
 
 /** Price of a caplet or floorlet using the BS model */
 double capFloorletBS(int payoffType, SPtrYieldCurve spyc, double strikeRate,double timeToReset, double tenor, double fwdRateVol);
 
 /** CDS present value calculation for both legs */
 Vector cdsPV(SPtrYieldCurve sprfyc, double credSprd, double cdsRate, double recov, double timeToMat, double payFreq);
+
+// Pricers templated on the number type.
+// With T = AReal and active inputs they record on the tape, giving all sensitivities in one
+// backward sweep; the double functions above call them with T = double.
+// The math functions are called unqualified, so that those of AReal are found by ADL.
+
+/** The forward price of an asset */
+template<typename T> requires (!std::is_integral_v<T>)
+T fwdPrice(T const& spot, T const& timeToExp, T const& intRate, T const& divYield)
+{
+  using std::exp;
+  QF_ASSERT(spot >= 0.0, "spot must be non-negative");
+  QF_ASSERT(timeToExp >= 0.0, "time to expiration must be non-negative");
+  QF_ASSERT(intRate >= 0.0, "interest rate must be non-negative");
+  QF_ASSERT(divYield >= 0.0, "dividend yield must be non-negative");
+
+  return spot * exp((intRate - divYield) * timeToExp);
+}
+
+/** Price of a European digital option in the Black-Scholes model */
+template<typename T> requires (!std::is_integral_v<T>)
+T digitalOptionBS(int payoffType, T const& spot, T const& strike, T const& timeToExp,
+                  T const& intRate, T const& divYield, T const& volatility)
+{
+  using std::exp;
+  using std::log;
+  using std::sqrt;
+  QF_ASSERT(payoffType == 1 || payoffType == -1, "payoffType must be 1 or -1");
+  QF_ASSERT(strike >= 0.0, "strike must be non-negative");
+  QF_ASSERT(divYield >= 0.0, "dividend yield must be non-negative");
+  QF_ASSERT(volatility >= 0.0, "volatility must be non-negative");
+
+  double phi = payoffType;
+  T fwd = fwdPrice<T>(spot, timeToExp, intRate, divYield);
+  T sigT = volatility * sqrt(timeToExp);
+  T d2 = log(fwd / strike) / sigT - 0.5 * sigT;
+
+  return exp(-intRate * timeToExp) * normalCdf(phi * d2);
+}
+
+/** Price of a European option in the Black-Scholes model */
+template<typename T> requires (!std::is_integral_v<T>)
+T europeanOptionBS(int payoffType, T const& spot, T const& strike, T const& timeToExp,
+                   T const& intRate, T const& divYield, T const& volatility)
+{
+  using std::exp;
+  using std::log;
+  using std::sqrt;
+  QF_ASSERT(payoffType == 1 || payoffType == -1, "payoffType must be 1 or -1");
+  QF_ASSERT(strike >= 0.0, "strike must be non-negative");
+  QF_ASSERT(volatility >= 0.0, "volatility must be non-negative");
+
+  double phi = payoffType;
+  T fwd = fwdPrice<T>(spot, timeToExp, intRate, divYield);
+  T sigT = volatility * sqrt(timeToExp);
+  T d1 = log(fwd / strike) / sigT + 0.5 * sigT;
+  T d2 = d1 - sigT;
+
+  T df = exp(-intRate * timeToExp);
+  T price = fwd * normalCdf(phi * d1) - strike * normalCdf(phi * d2);
+  price *= phi * df;
+
+  return price;
+}
+
+/** Price of a caplet or floorlet in the Black-Scholes model, on a curve such as YieldCurve
+    or YieldCurveT<T> whose discount() and fwdRate() return numbers convertible to T
+*/
+template<typename T, typename CURVE> requires (!std::is_integral_v<T>)
+T capFloorletBS(int payoffType, CURVE const& yc, T const& strikeRate, double timeToReset,
+                double tenor, T const& fwdRateVol)
+{
+  using std::exp;
+  using std::log;
+  using std::sqrt;
+  QF_ASSERT(payoffType == 1 || payoffType == -1, "payoffType must be 1 (cap) or -1 (floor)");
+  QF_ASSERT(strikeRate > 0.0, "strikeRate must be positive");
+  QF_ASSERT(timeToReset >= 0.0, "timeToReset must be non-negative");
+  QF_ASSERT(tenor > 0.0, "tenor must be positive");
+  QF_ASSERT(fwdRateVol > 0.0, "fwdRateVol must be positive");
+
+  double paymentTime = timeToReset + tenor;
+  T df = yc.discount(paymentTime);
+  T fwdRate = yc.fwdRate(timeToReset, paymentTime);
+  T fwdRateSimple = (exp(fwdRate * tenor) - 1.0) / tenor;
+  double phi = payoffType;
+  T sigma_sqrt_t = fwdRateVol * sqrt(timeToReset);
+  T d1 = (log(fwdRateSimple / strikeRate) + 0.5 * fwdRateVol * fwdRateVol * timeToReset) / sigma_sqrt_t;
+  T d2 = d1 - sigma_sqrt_t;
+
+  T N_d1 = normalCdf(phi * d1);
+  T N_d2 = normalCdf(phi * d2);
+  return phi * df * tenor * (fwdRateSimple * N_d1 - strikeRate * N_d2);
+}
+
+/** CDS present values of the default leg and the premium leg, on a curve as for capFloorletBS */
+template<typename T, typename CURVE> requires (!std::is_integral_v<T>)
+std::array<T, 2> cdsPV(CURVE const& rfyc, T const& credSprd, T const& cdsRate, T const& recov,
+                       double timeToMat, double payFreq)
+{
+  using std::exp;
+  QF_ASSERT(credSprd >= 0, "Credit spread must be non-negative");
+  QF_ASSERT(cdsRate >= 0, "CDS rate must be non-negative");
+  QF_ASSERT(recov >= 0 && recov <= 1, "Recovery rate must be between 0 and 1");
+  QF_ASSERT(timeToMat > 0, "Time to maturity must be positive");
+  QF_ASSERT(payFreq > 0, "Payment frequency must be positive");
+
+  int numPayments = static_cast<int>(std::ceil(timeToMat * payFreq));
+  T defaultPV = 0.0;
+  T premiumPV = 0.0;
+  T prevSurvivalProb = 1.0;
+  double prevPaymentTime = 0.0;
+  for (int i = 1; i <= numPayments; ++i) {
+    double paymentTime = std::min(i / payFreq, timeToMat);
+    T survivalProb = exp(-credSprd * paymentTime);
+    T discountFactor = rfyc.discount(paymentTime);
+    defaultPV += (1.0 - recov) * (prevSurvivalProb - survivalProb) * discountFactor;
+    premiumPV += cdsRate * survivalProb * discountFactor * (paymentTime - prevPaymentTime);
+    prevSurvivalProb = survivalProb;
+    prevPaymentTime = paymentTime;
+  }
+
+  return std::array<T, 2>{ defaultPV, premiumPV };
+}
        
 END_NAMESPACE(qf)
 
@@ -1,4 +1,4 @@
-/** 
+/**
 @file  sptrmap.hpp
 @brief Definition of the SPtrMap, a string-to-shared_ptr dictionary.
 */
@@ -7,8 +7,11 @@
 #define QF_SPTRMAP_HPP
 
 #include <qflib/sptr.hpp>
-#include <map>
+#include <qflib/exception.hpp>
+#include <atomic>
+#include <unordered_map>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cctype>
 #include <algorithm>
@@ -25,6 +28,12 @@ std::string trim(const std::string &s)
 }
 
 /** A string to smart pointer dictionary class.
+    Names are trimmed and upper-cased. Each name is interned in a slot of a dense vector, found
+    through a hash table; names that are already in that form are looked up without allocation.
+    handle() resolves a name once to its slot, and get() and version() by handle are O(1).
+    Handles stay valid when the object under a name is replaced, and in copies of the map,
+    until clear(). Each new or cleared map has a new generation number, which handles carry,
+    so a handle from before a clear() or from an unrelated map finds nothing.
 */
 template<typename T>
 class SPtrMap
@@ -32,9 +41,21 @@ class SPtrMap
 public:
   using ptr_type = std::shared_ptr<T>;
   using pair_type = std::pair<ptr_type, unsigned long>;
-  using map_type = std::map<std::string, pair_type>;
 
-  /** Returns a list of names of the contained objects */
+  /** A name resolved by handle(): its slot and the generation of the map it was taken from */
+  struct handle_type
+  {
+    size_t slot;
+    unsigned long generation;
+  };
+
+  /** The handle of names not in the map */
+  static constexpr handle_type NO_HANDLE = { size_t(-1), 0 };
+
+  /** Ctor of an empty map with a new generation */
+  SPtrMap() : generation_(newGeneration()) {}
+
+  /** Returns a list of names of the contained objects, in alphabetical order */
   std::vector<std::string> list() const;
 
   /** Returns true if the map contains an entry under this name */
@@ -43,41 +64,83 @@ public:
   /** Retrieves the smart pointer by name */
   ptr_type get(std::string const& name) const;
 
-  /** Stores the smart pointer to object using the passed-in name 
+  /** Retrieves the smart pointer by handle; null for NO_HANDLE and handles of another generation */
+  ptr_type get(handle_type h) const { return valid(h) ? slots_[h.slot].ptr : ptr_type(); }
+
+  /** Returns the handle of the entry under this name, or NO_HANDLE */
+  handle_type handle(std::string const& name) const;
+
+  /** Stores the smart pointer to object using the passed-in name
       Returns the name and the version number
   */
   std::pair<std::string, unsigned long> set(std::string const& name, ptr_type sp);
 
+  /** Stores the smart pointer to object using the passed-in name with the given version number,
+      e.g. when restoring a saved map; returns the name and the version number
+  */
+  std::pair<std::string, unsigned long> set(std::string const& name, ptr_type sp, unsigned long ver);
+
   /** Returns the version of the pointed object */
   unsigned long version(std::string const& name) const;
 
-  /** Clears the map and resets the current version to 0 */
+  /** Returns the version of the pointed object by handle; 0 for NO_HANDLE and handles of another generation */
+  unsigned long version(handle_type h) const { return valid(h) ? slots_[h.slot].version : 0; }
+
+  /** Clears the map and resets the current version to 0; all handles become invalid */
   void clear();
 
 private:
 
+  // An interned name with its object
+  struct Slot
+  {
+    std::string name;
+    ptr_type ptr;
+    unsigned long version;
+  };
+
+  // Hash and equality accepting std::string_view, for lookups without allocation
+  struct NameHash
+  {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>()(s); }
+  };
+  using index_type = std::unordered_map<std::string, size_t, NameHash, std::equal_to<>>;
+
+  // The slot of names not in the map
+  static constexpr size_t NO_SLOT = size_t(-1);
+
+  // Returns a generation number that no map had before
+  static unsigned long newGeneration()
+  {
+    static std::atomic<unsigned long> last(0);
+    return ++last;
+  }
+
+  // Returns true if h is a slot of this map and generation
+  bool valid(handle_type h) const { return h.generation == generation_ && h.slot < slots_.size(); }
+
   // Removes leading and trailing blanks and upper cases the passed in string.
   // Throws an exception if the string has internal blanks.
   std::string processName(std::string const& name) const;
 
-  // Helper function to retrieve the pointer and the version number
-  // Call processName() before calling this.
-  pair_type get_pair(std::string const& name) const;
+  // Returns true if processName() would return the name unchanged
+  static bool isProcessed(std::string const& name);
 
-  // Helper function to remove the pointer and the version number;
-  // returns true if the pair was found and removed.
-  // Call processName() before calling this.
-  bool remove_pair(std::string const& name);
+  // Returns the slot of the name, processing it only if needed
+  size_t find(std::string const& name) const;
 
   // state
-  map_type map_;            // the map
+  std::vector<Slot> slots_;   // the interned names and their objects
+  index_type index_;          // the slot of each name
+  unsigned long generation_;  // changed by clear(), kept by copies
 };
 
 ///////////////////////////////////////////////////////////////////////////////
 // Inline definitions
 
 template<typename T>
-inline std::string 
+inline std::string
 SPtrMap<T>::processName(std::string const& name) const {
     std::string ret = trim(name);
     QF_ASSERT(!ret.empty(), "empty object names not allowed");
@@ -88,70 +151,83 @@ SPtrMap<T>::processName(std::string const& name) const {
 }
 
 template<typename T>
-inline typename SPtrMap<T>::pair_type 
-SPtrMap<T>::get_pair(std::string const& name) const {
-    auto it = map_.find(name.c_str());
-    return it == map_.end() ? pair_type() : it->second;
+inline bool
+SPtrMap<T>::isProcessed(std::string const& name) {
+    return !name.empty() && std::none_of(name.begin(), name.end(),
+        [](unsigned char c) { return ::isspace(c) || ::toupper(c) != c; });
 }
 
 template<typename T>
-inline bool 
-SPtrMap<T>::remove_pair(std::string const& name) {
-    auto it = map_.find(name.c_str());
-    if (it == map_.end())
-        return false;
-    else {
-        map_.erase(it);
-    }
-    return true;
+inline size_t
+SPtrMap<T>::find(std::string const& name) const {
+    auto it = isProcessed(name) ? index_.find(std::string_view(name)) : index_.find(processName(name));
+    return it == index_.end() ? NO_SLOT : it->second;
 }
 
 template<typename T>
-inline std::vector<std::string> 
+inline std::vector<std::string>
 SPtrMap<T>::list() const {
     std::vector<std::string> lst;
-    for (auto cit = map_.begin(); cit != map_.end(); ++cit) 
-        lst.push_back(cit->first);
+    for (auto const& slot : slots_)
+        lst.push_back(slot.name);
+    std::sort(lst.begin(), lst.end());
     return lst;
 }
 
 template<typename T>
 inline bool SPtrMap<T>::contains(std::string const& name) const {
-    std::string nm = processName(name);
-    return map_.find(nm) != map_.end();
+    return find(name) != NO_SLOT;
 }
 
-template<typename T> 
-inline typename SPtrMap<T>::ptr_type 
+template<typename T>
+inline typename SPtrMap<T>::ptr_type
 SPtrMap<T>::get(std::string const& name) const {
-    std::string nm = processName(name);
-    return get_pair(nm).first;
+    size_t i = find(name);
+    return i == NO_SLOT ? ptr_type() : slots_[i].ptr;
+}
+
+template<typename T>
+inline typename SPtrMap<T>::handle_type
+SPtrMap<T>::handle(std::string const& name) const {
+    size_t i = find(name);
+    return i == NO_SLOT ? NO_HANDLE : handle_type{ i, generation_ };
 }
 
 template<typename T>
-inline std::pair<std::string, unsigned long> 
+inline std::pair<std::string, unsigned long>
 SPtrMap<T>::set(std::string const& name, ptr_type sp) {
     std::string nm = processName(name);
-    // first check if the object is already stored under this name
-    // if it does, record the version number
-    unsigned long ver = 0;
-    if (contains(nm)) {
-      ver = get_pair(nm).second;
-      bool b = remove_pair(nm);
+    // if the object is already stored under this name, replace it in its slot
+    auto it = index_.find(nm);
+    if (it != index_.end()) {
+        Slot& slot = slots_[it->second];
+        slot.ptr = std::move(sp);
+        return std::make_pair(nm, ++slot.version);
     }
-    map_.insert(std::make_pair(nm, std::make_pair(sp, ++ver)));
-    return std::make_pair(nm, ver);
+    index_.emplace(nm, slots_.size());
+    slots_.push_back(Slot{nm, std::move(sp), 1});
+    return std::make_pair(nm, 1ul);
+}
+
+template<typename T>
+inline std::pair<std::string, unsigned long>
+SPtrMap<T>::set(std::string const& name, ptr_type sp, unsigned long ver) {
+    std::pair<std::string, unsigned long> ret = set(name, std::move(sp));
+    slots_[index_.find(ret.first)->second].version = ver;
+    return std::make_pair(ret.first, ver);
 }
 
 template<typename T>
 inline unsigned long SPtrMap<T>::version(std::string const& name) const {
-    std::string nm = processName(name);
-    return get_pair(nm).second;
+    size_t i = find(name);
+    return i == NO_SLOT ? 0 : slots_[i].version;
 }
 
 template<typename T>
-inline void SPtrMap<T>::clear() { 
-    map_.clear(); 
+inline void SPtrMap<T>::clear() {
+    slots_.clear();
+    index_.clear();
+    generation_ = newGeneration();
     return;
 }
 
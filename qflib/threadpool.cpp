@@ -0,0 +1,183 @@
+/**
+@file  threadpool.cpp
+@brief Implementation of the ThreadPool singleton and the threadPool() free function
+*/
+
+#include <qflib/threadpool.hpp>
+#include <atomic>
+#include <exception>
+#include <algorithm>
+
+BEGIN_NAMESPACE(qf)
+
+namespace {
+
+// true on threads currently executing tasks of a parallel loop
+thread_local bool tl_inParallelLoop = false;
+
+// Marks the current thread as executing tasks for the lifetime of the object
+class InParallelLoop
+{
+public:
+  InParallelLoop() : prev_(tl_inParallelLoop) { tl_inParallelLoop = true; }
+  ~InParallelLoop() { tl_inParallelLoop = prev_; }
+private:
+  bool prev_;
+};
+
+} // anonymous namespace
+
+/** A parallel loop */
+struct ThreadPool::Job
+{
+  std::function<void(size_t)> const* task;
+  size_t nTasks;
+  std::atomic<size_t> next;     // next task to start
+  std::atomic<size_t> nDone;    // number of completed tasks
+  std::exception_ptr error;     // first exception thrown by a task
+  std::mutex errorMutex;
+};
+
+ThreadPool& ThreadPool::instance()
+{
+  static ThreadPool thePool;
+  return thePool;
+}
+
+ThreadPool::ThreadPool()
+: nWorkers_(0), generation_(0), stop_(false)
+{
+  size_t nhw = std::thread::hardware_concurrency();
+  start(nhw > 1 ? nhw - 1 : 0);
+}
+
+ThreadPool::~ThreadPool()
+{
+  stop();
+}
+
+void ThreadPool::resize(size_t nThreads)
+{
+  if (nThreads == 0)
+    nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  // checked before locking: the running loop holds loopMutex_ until its tasks complete
+  QF_ASSERT(!tl_inParallelLoop, "ThreadPool: cannot resize from within a parallel loop");
+  std::lock_guard<std::mutex> loopLock(loopMutex_);
+  stop();
+  start(nThreads - 1);
+}
+
+void ThreadPool::parallelFor(size_t nTasks, std::function<void(size_t)> const& task)
+{
+  if (nTasks == 0)
+    return;
+  // nested loops run on the calling thread
+  if (tl_inParallelLoop) {
+    for (size_t i = 0; i < nTasks; ++i)
+      task(i);
+    return;
+  }
+  // so do single tasks and loops on an empty pool, without waiting for the loop of another thread
+  if (nTasks == 1 || nWorkers_ == 0) {
+    InParallelLoop inLoop;
+    for (size_t i = 0; i < nTasks; ++i)
+      task(i);
+    return;
+  }
+
+  std::lock_guard<std::mutex> loopLock(loopMutex_);
+  // the pool may have been emptied by a resize meanwhile
+  if (workers_.empty()) {
+    InParallelLoop inLoop;
+    for (size_t i = 0; i < nTasks; ++i)
+      task(i);
+    return;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->task = &task;
+  job->nTasks = nTasks;
+  job->next = 0;
+  job->nDone = 0;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    job_ = job;
+    ++generation_;
+  }
+  wakeCv_.notify_all();
+
+  runTasks(*job);
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    doneCv_.wait(lock, [&job] { return job->nDone == job->nTasks; });
+    job_.reset();
+  }
+  if (job->error)
+    std::rethrow_exception(job->error);
+}
+
+void ThreadPool::start(size_t nWorkers)
+{
+  stop_ = false;
+  for (size_t i = 0; i < nWorkers; ++i)
+    workers_.emplace_back(&ThreadPool::workerLoop, this);
+  nWorkers_ = nWorkers;
+}
+
+void ThreadPool::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wakeCv_.notify_all();
+  for (auto& w : workers_)
+    w.join();
+  workers_.clear();
+  nWorkers_ = 0;
+}
+
+void ThreadPool::workerLoop()
+{
+  unsigned long seen = 0;
+  for (;;) {
+    std::shared_ptr<Job> job;
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wakeCv_.wait(lock, [this, seen] { return stop_ || (job_ && generation_ != seen); });
+      if (stop_)
+        return;
+      seen = generation_;
+      job = job_;
+    }
+    runTasks(*job);
+  }
+}
+
+void ThreadPool::runTasks(Job& job)
+{
+  InParallelLoop inLoop;
+  size_t i;
+  while ((i = job.next++) < job.nTasks) {
+    try {
+      (*job.task)(i);
+    }
+    catch (...) {
+      std::lock_guard<std::mutex> lock(job.errorMutex);
+      if (!job.error)
+        job.error = std::current_exception();
+    }
+    if (++job.nDone == job.nTasks) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      doneCv_.notify_all();
+    }
+  }
+}
+
+// The helper function
+ThreadPool& threadPool()
+{
+  return ThreadPool::instance();
+}
+
+END_NAMESPACE(qf)
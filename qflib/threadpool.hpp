@@ -0,0 +1,87 @@
+/**
+@file  threadpool.hpp
+@brief Definition of the thread pool singleton and the threadPool() free function
+*/
+
+#ifndef QF_THREADPOOL_HPP
+#define QF_THREADPOOL_HPP
+
+#include <qflib/defines.hpp>
+#include <qflib/exception.hpp>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <vector>
+
+BEGIN_NAMESPACE(qf)
+
+/** A pool of worker threads executing parallel loops.
+    The thread calling parallelFor takes part in the loop, so a pool of size n
+    runs n - 1 worker threads. Loops are executed one at a time; a parallelFor
+    called from within a task runs serially on the calling thread, and so does
+    a loop of one task or on a pool of size 1, without waiting for a running loop.
+*/
+class ThreadPool
+{
+public:
+
+  /** Returns the unique instance */
+  static ThreadPool& instance();
+
+  /** Returns the number of threads executing a parallel loop, including the caller */
+  size_t size() const { return nWorkers_ + 1; }
+
+  /** Sets the number of threads executing a parallel loop, including the caller.
+      If nThreads is 0, it is set to the number of hardware threads.
+  */
+  void resize(size_t nThreads);
+
+  /** Calls task(i) for i in [0, nTasks), distributing the calls over the threads of the pool.
+      Returns when all calls have completed. If any call throws, the first exception is
+      rethrown after all other calls have completed.
+  */
+  void parallelFor(size_t nTasks, std::function<void(size_t)> const& task);
+
+  /** dtor; joins the worker threads */
+  ~ThreadPool();
+
+private:
+
+  /** allow private default ctor */
+  ThreadPool();
+
+  /** forbid copy ctor, copy-assignment, move ctor and move assignment */
+  ThreadPool(ThreadPool const& rhs) = delete;
+  ThreadPool& operator=(ThreadPool const&) = delete;
+  ThreadPool(ThreadPool&& rhs) = delete;
+  ThreadPool& operator=(ThreadPool&&) = delete;
+
+  struct Job;
+
+  // helper functions
+  void start(size_t nWorkers);
+  void stop();
+  void workerLoop();
+  void runTasks(Job& job);
+
+  // state
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> nWorkers_;     // workers_.size(), readable without locking
+  std::shared_ptr<Job> job_;         // the current parallel loop
+  unsigned long generation_;         // incremented with each new loop
+  bool stop_;
+  std::mutex mutex_;                 // guards job_, generation_ and stop_
+  std::condition_variable wakeCv_;   // signals a new loop or stop to the workers
+  std::condition_variable doneCv_;   // signals the completion of the last task
+  std::mutex loopMutex_;             // serializes parallel loops and resizing
+};
+
+/** Free function returning the thread pool singleton */
+ThreadPool& threadPool();
+
+END_NAMESPACE(qf)
+
+#endif // QF_THREADPOOL_HPP